@@ -0,0 +1,86 @@
+#define _POSIX_C_SOURCE 199309L
+#include "convert.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_WIDTH 3840
+#define BENCH_HEIGHT 2160
+#define BENCH_ITERATIONS 20
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void fill_random(uint8_t* data, size_t size) {
+    uint32_t state = 0x12345678;
+    for (size_t index = 0; index < size; index++) {
+        state = state * 1664525 + 1013904223;
+        data[index] = (uint8_t)(state >> 24);
+    }
+}
+
+static void run_rows(Owl_Convert_Row_Func convert, uint8_t* dst, const uint8_t* src,
+                     int32_t src_stride, int32_t width, int32_t height) {
+    for (int32_t row = 0; row < height; row++) {
+        convert(dst + (size_t)row * width * 4, src + (size_t)row * src_stride, width);
+    }
+}
+
+int main(void) {
+    int32_t width = BENCH_WIDTH;
+    int32_t height = BENCH_HEIGHT;
+    size_t dst_size = (size_t)width * height * 4;
+
+    uint8_t* src = malloc(dst_size);
+    uint8_t* dst = malloc(dst_size);
+    uint8_t* reference = malloc(dst_size);
+    if (!src || !dst || !reference) {
+        fprintf(stderr, "convert_bench: out of memory\n");
+        return 1;
+    }
+    fill_random(src, dst_size);
+
+    printf("%dx%d, %d iterations, best impl: %s\n", width, height, BENCH_ITERATIONS,
+           owl_convert_impl_name(owl_convert_best_impl()));
+    printf("%-16s %-8s %10s %10s\n", "kind", "impl", "ms/frame", "GB/s");
+
+    int failures = 0;
+    for (int kind = OWL_CONVERT_NONE + 1; kind < OWL_CONVERT_COUNT; kind++) {
+        int32_t src_stride = width * owl_convert_src_bytes_per_pixel(kind);
+        size_t bytes = (size_t)(src_stride + width * 4) * height;
+
+        run_rows(owl_convert_get_row_func(kind, OWL_CONVERT_IMPL_SCALAR), reference, src,
+                 src_stride, width, height);
+
+        for (int impl = 0; impl < OWL_CONVERT_IMPL_COUNT; impl++) {
+            Owl_Convert_Row_Func convert = owl_convert_get_row_func(kind, impl);
+            if (!convert) {
+                continue;
+            }
+
+            memset(dst, 0, dst_size);
+            run_rows(convert, dst, src, src_stride, width, height);
+            bool matches = memcmp(dst, reference, dst_size) == 0;
+            failures += !matches;
+
+            double start = now_seconds();
+            for (int iteration = 0; iteration < BENCH_ITERATIONS; iteration++) {
+                run_rows(convert, dst, src, src_stride, width, height);
+            }
+            double elapsed = (now_seconds() - start) / BENCH_ITERATIONS;
+
+            printf("%-16s %-8s %10.3f %10.2f%s\n", owl_convert_kind_name(kind),
+                   owl_convert_impl_name(impl), elapsed * 1000.0, (double)bytes / elapsed / 1e9,
+                   matches ? "" : "  MISMATCH");
+        }
+    }
+
+    free(src);
+    free(dst);
+    free(reference);
+    return failures ? 1 : 0;
+}
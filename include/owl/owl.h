@@ -4,10 +4,14 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#define OWL_LATENCY_BUCKETS 12
+
 typedef struct Owl_Display Owl_Display;
 typedef struct Owl_Window Owl_Window;
 typedef struct Owl_Output Owl_Output;
 typedef struct Owl_Input Owl_Input;
+typedef struct Owl_Event_Source Owl_Event_Source;
+typedef struct Owl_Texture Owl_Texture;
 
 typedef enum {
     OWL_WINDOW_EVENT_CREATE,
@@ -22,6 +26,8 @@ typedef enum {
     OWL_WINDOW_EVENT_TITLE_CHANGE,
     OWL_WINDOW_EVENT_REQUEST_MOVE,
     OWL_WINDOW_EVENT_REQUEST_RESIZE,
+    OWL_WINDOW_EVENT_NOT_RESPONDING,
+    OWL_WINDOW_EVENT_RESPONDING,
 } Owl_Window_Event;
 
 typedef enum {
@@ -38,9 +44,68 @@ typedef enum {
     OWL_OUTPUT_EVENT_MODE_CHANGE,
 } Owl_Output_Event;
 
+typedef enum {
+    OWL_RENDER_STAGE_BEFORE_WINDOWS,
+    OWL_RENDER_STAGE_AFTER_WINDOWS,
+} Owl_Render_Stage;
+
+typedef enum {
+    OWL_YUV_ENCODING_AUTO,
+    OWL_YUV_ENCODING_BT601,
+    OWL_YUV_ENCODING_BT709,
+} Owl_Yuv_Encoding;
+
+typedef enum {
+    OWL_YUV_RANGE_LIMITED,
+    OWL_YUV_RANGE_FULL,
+} Owl_Yuv_Range;
+
+typedef struct Owl_Window_Event_Record {
+    Owl_Window_Event type;
+    Owl_Window* window;
+} Owl_Window_Event_Record;
+
+typedef struct Owl_Client_Quota {
+    uint32_t requests_per_iteration;
+    uint32_t flood_iterations;
+    uint32_t max_surfaces;
+    uint64_t max_shm_bytes;
+    uint32_t max_frame_callbacks;
+} Owl_Client_Quota;
+
+typedef struct Owl_Client_Stats {
+    uint64_t requests;
+    uint64_t bytes;
+    uint32_t resources;
+    uint32_t surfaces;
+    uint64_t shm_bytes;
+    uint64_t texture_bytes;
+    uint32_t frame_callbacks;
+    uint32_t deferrals;
+} Owl_Client_Stats;
+
+typedef struct Owl_Memory_Stats {
+    uint64_t texture_bytes;
+    uint64_t texture_budget;
+    uint64_t thumbnail_bytes;
+    uint64_t shm_bytes;
+    uint32_t resident_surfaces;
+    uint32_t evicted_surfaces;
+    uint64_t evictions;
+    uint64_t restores;
+} Owl_Memory_Stats;
+
 typedef void (*Owl_Window_Callback)(Owl_Display* display, Owl_Window* window, void* data);
+typedef void (*Owl_Window_Batch_Callback)(Owl_Display* display, const Owl_Window_Event_Record* events,
+                                          int count, void* data);
 typedef void (*Owl_Input_Callback)(Owl_Display* display, Owl_Input* input, void* data);
 typedef void (*Owl_Output_Callback)(Owl_Display* display, Owl_Output* output, void* data);
+typedef void (*Owl_Binding_Callback)(Owl_Display* display, Owl_Input* input, void* data);
+typedef void (*Owl_Task_Callback)(Owl_Display* display, void* data);
+typedef void (*Owl_Fd_Callback)(Owl_Display* display, int fd, uint32_t mask, void* data);
+typedef void (*Owl_Timer_Callback)(Owl_Display* display, void* data);
+typedef void (*Owl_Idle_Callback)(Owl_Display* display, void* data);
+typedef void (*Owl_Render_Hook)(Owl_Display* display, Owl_Output* output, void* data);
 
 Owl_Display* owl_display_create(void);
 void owl_display_destroy(Owl_Display* display);
@@ -49,13 +114,76 @@ void owl_display_terminate(Owl_Display* display);
 const char* owl_display_get_socket_name(Owl_Display* display);
 int owl_display_get_pointer_x(Owl_Display* display);
 int owl_display_get_pointer_y(Owl_Display* display);
+bool owl_display_set_cursor_theme(Owl_Display* display, const char* theme, int size);
+bool owl_display_set_cursor(Owl_Display* display, const char* name);
+void owl_display_set_motion_coalesce(Owl_Display* display, uint32_t window_ms);
+bool owl_display_post_task(Owl_Display* display, Owl_Task_Callback callback, void* data);
+
+Owl_Event_Source* owl_display_add_fd(Owl_Display* display, int fd, uint32_t mask,
+                                     Owl_Fd_Callback callback, void* data);
+Owl_Event_Source* owl_display_add_timer(Owl_Display* display, uint32_t delay_ms, uint32_t interval_ms,
+                                        Owl_Timer_Callback callback, void* data);
+Owl_Event_Source* owl_display_add_idle(Owl_Display* display, Owl_Idle_Callback callback, void* data);
+bool owl_event_source_set_mask(Owl_Event_Source* source, uint32_t mask);
+bool owl_event_source_set_timer(Owl_Event_Source* source, uint32_t delay_ms, uint32_t interval_ms);
+void owl_event_source_remove(Owl_Event_Source* source);
 
 Owl_Window** owl_get_windows(Owl_Display* display, int* count);
+Owl_Window* owl_display_next_window(Owl_Display* display, Owl_Window* previous);
 void owl_window_focus(Owl_Window* window);
 void owl_window_move(Owl_Window* window, int x, int y);
 void owl_window_resize(Owl_Window* window, int width, int height);
 void owl_window_close(Owl_Window* window);
 void owl_window_set_fullscreen(Owl_Window* window, bool fullscreen);
+void owl_window_set_yuv_encoding(Owl_Window* window, Owl_Yuv_Encoding encoding, Owl_Yuv_Range range);
+void owl_window_raise(Owl_Window* window);
+void owl_window_lower(Owl_Window* window);
+void owl_window_restack(Owl_Window* window, Owl_Window* sibling, bool above);
+int owl_window_get_stack_index(Owl_Window* window);
+
+void owl_layout_begin(Owl_Display* display);
+void owl_layout_commit(Owl_Display* display, uint32_t timeout_ms);
+bool owl_layout_in_flight(Owl_Display* display);
+
+bool owl_window_begin_move(Owl_Window* window);
+bool owl_window_begin_resize(Owl_Window* window, uint32_t edges);
+void owl_display_end_grab(Owl_Display* display);
+void owl_display_deny_grab_request(Owl_Display* display);
+bool owl_display_is_grabbing(Owl_Display* display);
+
+void owl_display_set_ping_interval(Owl_Display* display, uint32_t interval_ms, uint32_t timeout_ms);
+void owl_display_get_latency_histogram(Owl_Display* display, uint32_t buckets[OWL_LATENCY_BUCKETS]);
+void owl_window_ping(Owl_Window* window);
+bool owl_window_is_responding(Owl_Window* window);
+uint32_t owl_window_get_latency_usec(Owl_Window* window);
+
+void owl_display_set_client_quota(Owl_Display* display, const Owl_Client_Quota* quota);
+bool owl_window_get_client_stats(Owl_Window* window, Owl_Client_Stats* stats);
+
+void owl_display_set_texture_budget(Owl_Display* display, uint64_t bytes);
+void owl_display_get_memory_stats(Owl_Display* display, Owl_Memory_Stats* stats);
+uint64_t owl_window_get_texture_bytes(Owl_Window* window);
+
+void owl_output_set_workspace(Owl_Output* output, uint32_t workspace);
+uint32_t owl_output_get_workspace(Owl_Output* output);
+void owl_window_set_workspace(Owl_Window* window, Owl_Output* output, uint32_t workspace);
+uint32_t owl_window_get_workspace(Owl_Window* window);
+Owl_Output* owl_window_get_output(Owl_Window* window);
+bool owl_window_is_hidden(Owl_Window* window);
+
+void owl_display_set_thumbnail_interval(Owl_Display* display, uint32_t interval_ms);
+bool owl_window_get_thumbnail_size(Owl_Window* window, int32_t* width, int32_t* height);
+bool owl_window_read_thumbnail(Owl_Window* window, uint32_t* argb_pixels, int32_t width, int32_t height);
+
+Owl_Texture* owl_texture_create(Owl_Display* display, const uint32_t* argb_pixels, int32_t width, int32_t height);
+bool owl_texture_update(Owl_Texture* texture, const uint32_t* argb_pixels);
+void owl_texture_destroy(Owl_Texture* texture);
+void owl_draw_rect(Owl_Display* display, int x, int y, int width, int height,
+                   float red, float green, float blue, float alpha);
+void owl_draw_texture(Owl_Display* display, Owl_Texture* texture, int x, int y, int width, int height);
+bool owl_draw_window_thumbnail(Owl_Display* display, Owl_Window* window, int x, int y, int width, int height);
+void owl_output_add_damage(Owl_Output* output, int x, int y, int width, int height);
+void owl_display_add_damage(Owl_Display* display, int x, int y, int width, int height);
 
 int owl_window_get_x(Owl_Window* window);
 int owl_window_get_y(Owl_Window* window);
@@ -74,8 +202,17 @@ int owl_output_get_height(Owl_Output* output);
 const char* owl_output_get_name(Owl_Output* output);
 
 void owl_set_window_callback(Owl_Display* display, Owl_Window_Event type, Owl_Window_Callback callback, void* data);
+void owl_set_window_batch_callback(Owl_Display* display, Owl_Window_Batch_Callback callback, void* data);
 void owl_set_input_callback(Owl_Display* display, Owl_Input_Event type, Owl_Input_Callback callback, void* data);
 void owl_set_output_callback(Owl_Display* display, Owl_Output_Event type, Owl_Output_Callback callback, void* data);
+void owl_set_render_hook(Owl_Display* display, Owl_Render_Stage stage, Owl_Render_Hook hook, void* data);
+
+bool owl_bind_key(Owl_Display* display, const char* mode, uint32_t modifiers, uint32_t keysym,
+                  uint32_t flags, Owl_Binding_Callback callback, void* data);
+bool owl_unbind_key(Owl_Display* display, const char* mode, uint32_t modifiers, uint32_t keysym,
+                    uint32_t flags);
+bool owl_set_binding_mode(Owl_Display* display, const char* mode, bool oneshot);
+const char* owl_get_binding_mode(Owl_Display* display);
 
 uint32_t owl_input_get_keycode(Owl_Input* input);
 uint32_t owl_input_get_keysym(Owl_Input* input);
@@ -83,10 +220,23 @@ uint32_t owl_input_get_modifiers(Owl_Input* input);
 uint32_t owl_input_get_button(Owl_Input* input);
 int owl_input_get_pointer_x(Owl_Input* input);
 int owl_input_get_pointer_y(Owl_Input* input);
+uint64_t owl_input_get_time_usec(Owl_Input* input);
 
 #define OWL_MOD_SHIFT   (1 << 0)
 #define OWL_MOD_CTRL    (1 << 1)
 #define OWL_MOD_ALT     (1 << 2)
 #define OWL_MOD_SUPER   (1 << 3)
 
+#define OWL_BINDING_RELEASE (1 << 0)
+
+#define OWL_EDGE_TOP    (1 << 0)
+#define OWL_EDGE_BOTTOM (1 << 1)
+#define OWL_EDGE_LEFT   (1 << 2)
+#define OWL_EDGE_RIGHT  (1 << 3)
+
+#define OWL_EVENT_READABLE (1 << 0)
+#define OWL_EVENT_WRITABLE (1 << 1)
+#define OWL_EVENT_HANGUP   (1 << 2)
+#define OWL_EVENT_ERROR    (1 << 3)
+
 #endif
@@ -1,4 +1,5 @@
 #include "internal.h"
+#include <stdlib.h>
 
 void owl_set_window_callback(
         Owl_Display* display,
@@ -6,18 +7,17 @@ void owl_set_window_callback(
         Owl_Window_Callback callback,
         void* data
     ) {
-    if (!display || type < 0 || type > OWL_WINDOW_EVENT_REQUEST_RESIZE) {
+    if (!display || type < 0 || type >= OWL_WINDOW_EVENT_COUNT) {
         return;
     }
 
-    int count = display->window_callback_count[type];
-    if (count >= OWL_MAX_CALLBACKS) {
+    Window_Callback_Entry* entry = wl_array_add(&display->window_callbacks[type], sizeof(Window_Callback_Entry));
+    if (!entry) {
         return;
     }
 
-    display->window_callbacks[type][count].callback = callback;
-    display->window_callbacks[type][count].data = data;
-    display->window_callback_count[type]++;
+    entry->callback = callback;
+    entry->data = data;
 }
 
 void owl_set_input_callback(
@@ -30,14 +30,13 @@ void owl_set_input_callback(
         return;
     }
 
-    int count = display->input_callback_count[type];
-    if (count >= OWL_MAX_CALLBACKS) {
+    Input_Callback_Entry* entry = wl_array_add(&display->input_callbacks[type], sizeof(Input_Callback_Entry));
+    if (!entry) {
         return;
     }
 
-    display->input_callbacks[type][count].callback = callback;
-    display->input_callbacks[type][count].data = data;
-    display->input_callback_count[type]++;
+    entry->callback = callback;
+    entry->data = data;
 }
 
 void owl_set_output_callback(
@@ -50,28 +49,218 @@ void owl_set_output_callback(
         return;
     }
 
-    int count = display->output_callback_count[type];
-    if (count >= OWL_MAX_CALLBACKS) {
+    Output_Callback_Entry* entry = wl_array_add(&display->output_callbacks[type], sizeof(Output_Callback_Entry));
+    if (!entry) {
         return;
     }
 
-    display->output_callbacks[type][count].callback = callback;
-    display->output_callbacks[type][count].data = data;
-    display->output_callback_count[type]++;
+    entry->callback = callback;
+    entry->data = data;
+}
+
+void owl_set_render_hook(
+        Owl_Display* display,
+        Owl_Render_Stage stage,
+        Owl_Render_Hook hook,
+        void* data
+    ) {
+    if (!display || !hook || stage < 0 || stage >= OWL_RENDER_STAGE_COUNT) {
+        return;
+    }
+
+    Render_Hook_Entry* entry = wl_array_add(&display->render_hooks[stage], sizeof(Render_Hook_Entry));
+    if (!entry) {
+        return;
+    }
+
+    entry->hook = hook;
+    entry->data = data;
+}
+
+void owl_set_window_batch_callback(Owl_Display* display, Owl_Window_Batch_Callback callback, void* data) {
+    if (!display) {
+        return;
+    }
+
+    if (!callback) {
+        display->window_event_head += display->window_event_count;
+        display->window_event_count = 0;
+    }
+    display->window_batch_callback = callback;
+    display->window_batch_data = data;
+}
+
+void owl_callbacks_cleanup(Owl_Display* display) {
+    for (int type = 0; type < OWL_WINDOW_EVENT_COUNT; type++) {
+        wl_array_release(&display->window_callbacks[type]);
+        wl_array_init(&display->window_callbacks[type]);
+    }
+    for (int type = 0; type <= OWL_INPUT_POINTER_MOTION; type++) {
+        wl_array_release(&display->input_callbacks[type]);
+        wl_array_init(&display->input_callbacks[type]);
+    }
+    for (int type = 0; type <= OWL_OUTPUT_EVENT_MODE_CHANGE; type++) {
+        wl_array_release(&display->output_callbacks[type]);
+        wl_array_init(&display->output_callbacks[type]);
+    }
+    for (int stage = 0; stage < OWL_RENDER_STAGE_COUNT; stage++) {
+        wl_array_release(&display->render_hooks[stage]);
+        wl_array_init(&display->render_hooks[stage]);
+    }
+
+    free(display->window_events);
+    display->window_events = NULL;
+    display->window_event_count = 0;
+    display->window_event_capacity = 0;
+    wl_array_release(&display->window_event_batch);
+    wl_array_init(&display->window_event_batch);
+}
+
+static int coalesce_key(Owl_Window_Event type) {
+    switch (type) {
+    case OWL_WINDOW_EVENT_FOCUS:
+    case OWL_WINDOW_EVENT_UNFOCUS:
+        return OWL_WINDOW_EVENT_FOCUS;
+    case OWL_WINDOW_EVENT_NOT_RESPONDING:
+    case OWL_WINDOW_EVENT_RESPONDING:
+        return OWL_WINDOW_EVENT_NOT_RESPONDING;
+    case OWL_WINDOW_EVENT_MOVE:
+    case OWL_WINDOW_EVENT_RESIZE:
+    case OWL_WINDOW_EVENT_FULLSCREEN:
+    case OWL_WINDOW_EVENT_TITLE_CHANGE:
+        return type;
+    default:
+        return -1;
+    }
+}
+
+static Queued_Window_Event* queued_event(Owl_Display* display, uint32_t sequence) {
+    if (sequence - display->window_event_head >= display->window_event_count) {
+        return NULL;
+    }
+    return &display->window_events[sequence & (display->window_event_capacity - 1)];
+}
+
+static bool grow_window_events(Owl_Display* display) {
+    if (display->window_event_count < display->window_event_capacity) {
+        return true;
+    }
+
+    uint32_t capacity = display->window_event_capacity ? display->window_event_capacity * 2 : 64;
+    Queued_Window_Event* events = malloc(capacity * sizeof(Queued_Window_Event));
+    if (!events) {
+        return false;
+    }
+
+    for (uint32_t index = 0; index < display->window_event_count; index++) {
+        uint32_t sequence = display->window_event_head + index;
+        events[sequence & (capacity - 1)] =
+            display->window_events[sequence & (display->window_event_capacity - 1)];
+    }
+
+    free(display->window_events);
+    display->window_events = events;
+    display->window_event_capacity = capacity;
+    return true;
+}
+
+void owl_drop_window_events(Owl_Display* display, Owl_Window* window) {
+    for (uint32_t index = 0; index < display->window_event_count; index++) {
+        Queued_Window_Event* event = queued_event(display, display->window_event_head + index);
+        if (event->window == window) {
+            event->window = NULL;
+        }
+    }
+}
+
+static void queue_window_event(Owl_Display* display, Owl_Window_Event type, Owl_Window* window) {
+    int key = coalesce_key(type);
+    if (key >= 0 && window->queued_events[key]) {
+        Queued_Window_Event* previous = queued_event(display, window->queued_events[key] - 1);
+        if (previous && previous->window == window && coalesce_key(previous->type) == key) {
+            previous->window = NULL;
+        }
+    }
+
+    if (!grow_window_events(display)) {
+        return;
+    }
+
+    uint32_t sequence = display->window_event_head + display->window_event_count++;
+    display->window_events[sequence & (display->window_event_capacity - 1)] = (Queued_Window_Event){
+        .type = type,
+        .window = window,
+        .sequence = sequence,
+    };
+    if (key >= 0) {
+        window->queued_events[key] = sequence + 1;
+    }
+}
+
+static void deliver_window_batch(Owl_Display* display, const Owl_Window_Event_Record* events, int count) {
+    bool nested = display->window_events_delivering;
+    display->window_events_delivering = true;
+    display->window_batch_callback(display, events, count, display->window_batch_data);
+    display->window_events_delivering = nested;
+}
+
+void owl_flush_window_events(Owl_Display* display) {
+    if (!display->window_event_count || display->window_events_delivering) {
+        return;
+    }
+
+    struct wl_array* batch = &display->window_event_batch;
+    batch->size = 0;
+    for (uint32_t index = 0; index < display->window_event_count; index++) {
+        Queued_Window_Event* event = queued_event(display, display->window_event_head + index);
+        if (!event->window) {
+            continue;
+        }
+        Owl_Window_Event_Record* record = wl_array_add(batch, sizeof(Owl_Window_Event_Record));
+        if (record) {
+            *record = (Owl_Window_Event_Record){ event->type, event->window };
+        }
+    }
+    display->window_event_head += display->window_event_count;
+    display->window_event_count = 0;
+
+    int count = (int)(batch->size / sizeof(Owl_Window_Event_Record));
+    if (count && display->window_batch_callback) {
+        deliver_window_batch(display, batch->data, count);
+    }
 }
 
 void owl_invoke_window_callback(Owl_Display* display, Owl_Window_Event type, Owl_Window* window) {
-    if (!display || type < 0 || type > OWL_WINDOW_EVENT_REQUEST_RESIZE) {
+    if (!display || type < 0 || type >= OWL_WINDOW_EVENT_COUNT) {
         return;
     }
 
-    int count = display->window_callback_count[type];
-    for (int index = 0; index < count; index++) {
-        Window_Callback_Entry* entry = &display->window_callbacks[type][index];
-        if (entry->callback) {
-            entry->callback(display, window, entry->data);
+    struct wl_array* callbacks = &display->window_callbacks[type];
+    for (size_t index = 0; index < callbacks->size / sizeof(Window_Callback_Entry); index++) {
+        Window_Callback_Entry entry = ((Window_Callback_Entry*)callbacks->data)[index];
+        if (entry.callback) {
+            entry.callback(display, window, entry.data);
         }
     }
+
+    if (!display->window_batch_callback || !window) {
+        return;
+    }
+
+    if (type != OWL_WINDOW_EVENT_DESTROY) {
+        queue_window_event(display, type, window);
+        return;
+    }
+
+    if (display->window_events_delivering) {
+        owl_drop_window_events(display, window);
+        Owl_Window_Event_Record record = { type, window };
+        deliver_window_batch(display, &record, 1);
+        return;
+    }
+
+    queue_window_event(display, type, window);
+    owl_flush_window_events(display);
 }
 
 void owl_invoke_input_callback(Owl_Display* display, Owl_Input_Event type, Owl_Input* input) {
@@ -79,11 +268,11 @@ void owl_invoke_input_callback(Owl_Display* display, Owl_Input_Event type, Owl_I
         return;
     }
 
-    int count = display->input_callback_count[type];
-    for (int index = 0; index < count; index++) {
-        Input_Callback_Entry* entry = &display->input_callbacks[type][index];
-        if (entry->callback) {
-            entry->callback(display, input, entry->data);
+    struct wl_array* callbacks = &display->input_callbacks[type];
+    for (size_t index = 0; index < callbacks->size / sizeof(Input_Callback_Entry); index++) {
+        Input_Callback_Entry entry = ((Input_Callback_Entry*)callbacks->data)[index];
+        if (entry.callback) {
+            entry.callback(display, input, entry.data);
         }
     }
 }
@@ -93,11 +282,26 @@ void owl_invoke_output_callback(Owl_Display* display, Owl_Output_Event type, Owl
         return;
     }
 
-    int count = display->output_callback_count[type];
-    for (int index = 0; index < count; index++) {
-        Output_Callback_Entry* entry = &display->output_callbacks[type][index];
-        if (entry->callback) {
-            entry->callback(display, output, entry->data);
+    struct wl_array* callbacks = &display->output_callbacks[type];
+    for (size_t index = 0; index < callbacks->size / sizeof(Output_Callback_Entry); index++) {
+        Output_Callback_Entry entry = ((Output_Callback_Entry*)callbacks->data)[index];
+        if (entry.callback) {
+            entry.callback(display, output, entry.data);
+        }
+    }
+}
+
+void owl_invoke_render_hooks(Owl_Display* display, Owl_Output* output) {
+    display->recording_output = output;
+    for (int stage = 0; stage < OWL_RENDER_STAGE_COUNT; stage++) {
+        output->draw_commands[stage].size = 0;
+        display->recording_stage = stage;
+
+        struct wl_array* hooks = &display->render_hooks[stage];
+        for (size_t index = 0; index < hooks->size / sizeof(Render_Hook_Entry); index++) {
+            Render_Hook_Entry entry = ((Render_Hook_Entry*)hooks->data)[index];
+            entry.hook(display, output, entry.data);
         }
     }
+    display->recording_output = NULL;
 }
@@ -0,0 +1,224 @@
+#define _GNU_SOURCE
+#include "internal.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <wayland-server-core.h>
+
+static void detach_list(struct wl_list* list) {
+    while (!wl_list_empty(list)) {
+        struct wl_list* link = list->next;
+        wl_list_remove(link);
+        wl_list_init(link);
+    }
+}
+
+static void client_destroyed(struct wl_listener* listener, void* data) {
+    (void)data;
+    Owl_Client* client = wl_container_of(listener, client, destroy);
+    Owl_Display* display = client->display;
+
+    if (display->keyboard_focus_client == client) {
+        display->keyboard_focus_client = NULL;
+    }
+    if (display->pointer_focus_client == client) {
+        display->pointer_focus_client = NULL;
+    }
+
+    detach_list(&client->keyboards);
+    detach_list(&client->pointers);
+    detach_list(&client->relative_pointers);
+    detach_list(&client->input_timestamps);
+
+    wl_list_remove(&client->destroy.link);
+    wl_list_remove(&client->link);
+    free(client);
+}
+
+static void client_created(struct wl_listener* listener, void* data) {
+    Owl_Display* display = wl_container_of(listener, display, client_created);
+    struct wl_client* wl_client = data;
+
+    Owl_Client* client = calloc(1, sizeof(Owl_Client));
+    if (!client) {
+        fprintf(stderr, "owl: failed to allocate client state\n");
+        wl_client_post_no_memory(wl_client);
+        return;
+    }
+
+    client->display = display;
+    client->client = wl_client;
+    wl_list_init(&client->keyboards);
+    wl_list_init(&client->pointers);
+    wl_list_init(&client->relative_pointers);
+    wl_list_init(&client->input_timestamps);
+
+    client->destroy.notify = client_destroyed;
+    wl_client_add_destroy_listener(wl_client, &client->destroy);
+    wl_list_insert(&display->clients, &client->link);
+}
+
+static uint32_t message_size(const struct wl_protocol_logger_message* message) {
+    uint32_t size = 8;
+    const char* signature = message->message->signature;
+    int argument = 0;
+    for (; *signature && argument < message->arguments_count; signature++) {
+        const union wl_argument* value = &message->arguments[argument];
+        switch (*signature) {
+        case 'i':
+        case 'u':
+        case 'f':
+        case 'o':
+        case 'n':
+            size += 4;
+            argument++;
+            break;
+        case 's':
+            size += 4 + (value->s ? ((uint32_t)strlen(value->s) + 4) & ~3u : 0);
+            argument++;
+            break;
+        case 'a':
+            size += 4 + (value->a ? ((uint32_t)value->a->size + 3) & ~3u : 0);
+            argument++;
+            break;
+        case 'h':
+            argument++;
+            break;
+        default:
+            break;
+        }
+    }
+    return size;
+}
+
+static void log_request(void* data, enum wl_protocol_logger_type direction,
+                        const struct wl_protocol_logger_message* message) {
+    Owl_Display* display = data;
+    if (direction != WL_PROTOCOL_LOGGER_REQUEST) {
+        return;
+    }
+
+    Owl_Client* client = owl_client_from_resource(message->resource);
+    if (!client) {
+        return;
+    }
+
+    client->requests++;
+    client->bytes += message_size(message);
+    uint32_t budget = display->client_quota.requests_per_iteration;
+    if (budget && ++client->iteration_requests > budget && !client->over_budget) {
+        client->over_budget = true;
+        client->deferrals++;
+    }
+}
+
+void owl_client_init(Owl_Display* display) {
+    wl_list_init(&display->clients);
+    display->client_created.notify = client_created;
+    wl_display_add_client_created_listener(display->wayland_display, &display->client_created);
+    display->client_quota.requests_per_iteration = 1000;
+    display->protocol_logger = wl_display_add_protocol_logger(display->wayland_display, log_request, display);
+}
+
+void owl_client_cleanup(Owl_Display* display) {
+    wl_list_remove(&display->client_created.link);
+    wl_list_init(&display->client_created.link);
+    if (display->protocol_logger) {
+        wl_protocol_logger_destroy(display->protocol_logger);
+        display->protocol_logger = NULL;
+    }
+}
+
+void owl_client_disconnect(Owl_Client* client, const char* reason) {
+    if (client->disconnecting) {
+        return;
+    }
+    client->disconnecting = true;
+    fprintf(stderr, "owl: disconnecting client %p: %s\n", (void*)client->client, reason);
+    wl_client_post_implementation_error(client->client, "%s", reason);
+}
+
+void owl_clients_begin_iteration(Owl_Display* display) {
+    uint32_t flood_iterations = display->client_quota.flood_iterations;
+    bool deferred = false;
+
+    Owl_Client* client;
+    wl_list_for_each(client, &display->clients, link) {
+        if (client->over_budget) {
+            client->flood_strikes++;
+            deferred |= client->frame_callbacks > 0;
+            if (flood_iterations && client->flood_strikes >= flood_iterations) {
+                owl_client_disconnect(client, "request flood");
+            }
+        } else {
+            client->flood_strikes = 0;
+        }
+        client->over_budget = false;
+        client->iteration_requests = 0;
+    }
+
+    if (deferred) {
+        owl_display_schedule_frame(display);
+    }
+}
+
+bool owl_client_throttled(Owl_Client* client) {
+    return client && (client->not_responding || client->over_budget);
+}
+
+bool owl_client_quota_exceeded(Owl_Client* client, uint64_t value, uint64_t limit, const char* reason) {
+    if (!client || !limit || value <= limit) {
+        return false;
+    }
+    owl_client_disconnect(client, reason);
+    return true;
+}
+
+void owl_display_set_client_quota(Owl_Display* display, const Owl_Client_Quota* quota) {
+    if (display && quota) {
+        display->client_quota = *quota;
+    }
+}
+
+static enum wl_iterator_result count_resource(struct wl_resource* resource, void* data) {
+    (void)resource;
+    (*(uint32_t*)data)++;
+    return WL_ITERATOR_CONTINUE;
+}
+
+bool owl_window_get_client_stats(Owl_Window* window, Owl_Client_Stats* stats) {
+    Owl_Client* client = window ? owl_client_from_resource(window->xdg_surface_resource) : NULL;
+    if (!client || !stats) {
+        return false;
+    }
+
+    *stats = (Owl_Client_Stats){
+        .requests = client->requests,
+        .bytes = client->bytes,
+        .surfaces = client->surface_count,
+        .shm_bytes = client->shm_bytes,
+        .texture_bytes = client->texture_bytes,
+        .frame_callbacks = client->frame_callbacks,
+        .deferrals = client->deferrals,
+    };
+    wl_client_for_each_resource(client->client, count_resource, &stats->resources);
+    return true;
+}
+
+Owl_Client* owl_client_from_wl(struct wl_client* wl_client) {
+    if (!wl_client) {
+        return NULL;
+    }
+
+    struct wl_listener* listener = wl_client_get_destroy_listener(wl_client, client_destroyed);
+    if (!listener) {
+        return NULL;
+    }
+
+    Owl_Client* client = wl_container_of(listener, client, destroy);
+    return client;
+}
+
+Owl_Client* owl_client_from_resource(struct wl_resource* resource) {
+    return resource ? owl_client_from_wl(wl_resource_get_client(resource)) : NULL;
+}
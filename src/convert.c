@@ -0,0 +1,275 @@
+#include "convert.h"
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define OWL_CONVERT_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+static inline uint32_t load_u32(const uint8_t* src) {
+    uint32_t value;
+    memcpy(&value, src, sizeof(value));
+    return value;
+}
+
+static inline void store_u32(uint8_t* dst, uint32_t value) {
+    memcpy(dst, &value, sizeof(value));
+}
+
+static inline uint32_t convert_2101010_pixel(uint32_t pixel) {
+    uint32_t alpha = pixel >> 30;
+    alpha |= alpha << 2;
+    alpha |= alpha << 4;
+    return ((pixel >> 2) & 0xFF) | ((pixel >> 4) & 0xFF00) | ((pixel >> 6) & 0xFF0000) | (alpha << 24);
+}
+
+static void convert_888_scalar(uint8_t* dst, const uint8_t* src, int32_t width) {
+    for (int32_t x = 0; x < width; x++) {
+        dst[x * 4 + 0] = src[x * 3 + 0];
+        dst[x * 4 + 1] = src[x * 3 + 1];
+        dst[x * 4 + 2] = src[x * 3 + 2];
+        dst[x * 4 + 3] = 0xFF;
+    }
+}
+
+static void convert_2101010_scalar(uint8_t* dst, const uint8_t* src, int32_t width) {
+    for (int32_t x = 0; x < width; x++) {
+        store_u32(dst + x * 4, convert_2101010_pixel(load_u32(src + x * 4)));
+    }
+}
+
+#ifdef OWL_CONVERT_X86
+
+__attribute__((target("sse2")))
+static void convert_888_sse2(uint8_t* dst, const uint8_t* src, int32_t width) {
+    const __m128i mask0 = _mm_set_epi32(0, 0, 0, 0x00FFFFFF);
+    const __m128i mask1 = _mm_set_epi32(0, 0, 0x00FFFFFF, 0);
+    const __m128i mask2 = _mm_set_epi32(0, 0x00FFFFFF, 0, 0);
+    const __m128i mask3 = _mm_set_epi32(0x00FFFFFF, 0, 0, 0);
+    const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+
+    int32_t x = 0;
+    for (; x + 6 <= width; x += 4) {
+        __m128i pixels = _mm_loadu_si128((const __m128i*)(src + x * 3));
+        __m128i out = _mm_and_si128(pixels, mask0);
+        out = _mm_or_si128(out, _mm_and_si128(_mm_slli_si128(pixels, 1), mask1));
+        out = _mm_or_si128(out, _mm_and_si128(_mm_slli_si128(pixels, 2), mask2));
+        out = _mm_or_si128(out, _mm_and_si128(_mm_slli_si128(pixels, 3), mask3));
+        _mm_storeu_si128((__m128i*)(dst + x * 4), _mm_or_si128(out, alpha));
+    }
+
+    convert_888_scalar(dst + x * 4, src + x * 3, width - x);
+}
+
+__attribute__((target("sse2")))
+static void convert_2101010_sse2(uint8_t* dst, const uint8_t* src, int32_t width) {
+    const __m128i mask0 = _mm_set1_epi32(0xFF);
+    const __m128i mask1 = _mm_set1_epi32(0xFF00);
+    const __m128i mask2 = _mm_set1_epi32(0xFF0000);
+
+    int32_t x = 0;
+    for (; x + 4 <= width; x += 4) {
+        __m128i pixels = _mm_loadu_si128((const __m128i*)(src + x * 4));
+        __m128i alpha = _mm_srli_epi32(pixels, 30);
+        alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 2));
+        alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 4));
+
+        __m128i out = _mm_and_si128(_mm_srli_epi32(pixels, 2), mask0);
+        out = _mm_or_si128(out, _mm_and_si128(_mm_srli_epi32(pixels, 4), mask1));
+        out = _mm_or_si128(out, _mm_and_si128(_mm_srli_epi32(pixels, 6), mask2));
+        out = _mm_or_si128(out, _mm_slli_epi32(alpha, 24));
+        _mm_storeu_si128((__m128i*)(dst + x * 4), out);
+    }
+
+    convert_2101010_scalar(dst + x * 4, src + x * 4, width - x);
+}
+
+__attribute__((target("avx2")))
+static void convert_888_avx2(uint8_t* dst, const uint8_t* src, int32_t width) {
+    const __m256i shuffle = _mm256_setr_epi8(
+        0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+        0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m256i alpha = _mm256_set1_epi32((int)0xFF000000);
+
+    int32_t x = 0;
+    for (; x + 10 <= width; x += 8) {
+        __m128i low = _mm_loadu_si128((const __m128i*)(src + x * 3));
+        __m128i high = _mm_loadu_si128((const __m128i*)(src + x * 3 + 12));
+        __m256i pixels = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+        __m256i out = _mm256_or_si256(_mm256_shuffle_epi8(pixels, shuffle), alpha);
+        _mm256_storeu_si256((__m256i*)(dst + x * 4), out);
+    }
+
+    convert_888_sse2(dst + x * 4, src + x * 3, width - x);
+}
+
+__attribute__((target("avx2")))
+static void convert_2101010_avx2(uint8_t* dst, const uint8_t* src, int32_t width) {
+    const __m256i mask0 = _mm256_set1_epi32(0xFF);
+    const __m256i mask1 = _mm256_set1_epi32(0xFF00);
+    const __m256i mask2 = _mm256_set1_epi32(0xFF0000);
+
+    int32_t x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m256i pixels = _mm256_loadu_si256((const __m256i*)(src + x * 4));
+        __m256i alpha = _mm256_srli_epi32(pixels, 30);
+        alpha = _mm256_or_si256(alpha, _mm256_slli_epi32(alpha, 2));
+        alpha = _mm256_or_si256(alpha, _mm256_slli_epi32(alpha, 4));
+
+        __m256i out = _mm256_and_si256(_mm256_srli_epi32(pixels, 2), mask0);
+        out = _mm256_or_si256(out, _mm256_and_si256(_mm256_srli_epi32(pixels, 4), mask1));
+        out = _mm256_or_si256(out, _mm256_and_si256(_mm256_srli_epi32(pixels, 6), mask2));
+        out = _mm256_or_si256(out, _mm256_slli_epi32(alpha, 24));
+        _mm256_storeu_si256((__m256i*)(dst + x * 4), out);
+    }
+
+    convert_2101010_scalar(dst + x * 4, src + x * 4, width - x);
+}
+
+#endif
+
+#if defined(__ARM_NEON)
+
+static void convert_888_neon(uint8_t* dst, const uint8_t* src, int32_t width) {
+    int32_t x = 0;
+    for (; x + 16 <= width; x += 16) {
+        uint8x16x3_t pixels = vld3q_u8(src + x * 3);
+        uint8x16x4_t out;
+        out.val[0] = pixels.val[0];
+        out.val[1] = pixels.val[1];
+        out.val[2] = pixels.val[2];
+        out.val[3] = vdupq_n_u8(0xFF);
+        vst4q_u8(dst + x * 4, out);
+    }
+
+    convert_888_scalar(dst + x * 4, src + x * 3, width - x);
+}
+
+static void convert_2101010_neon(uint8_t* dst, const uint8_t* src, int32_t width) {
+    const uint32x4_t mask0 = vdupq_n_u32(0xFF);
+    const uint32x4_t mask1 = vdupq_n_u32(0xFF00);
+    const uint32x4_t mask2 = vdupq_n_u32(0xFF0000);
+
+    int32_t x = 0;
+    for (; x + 4 <= width; x += 4) {
+        uint32x4_t pixels = vreinterpretq_u32_u8(vld1q_u8(src + x * 4));
+        uint32x4_t alpha = vshrq_n_u32(pixels, 30);
+        alpha = vorrq_u32(alpha, vshlq_n_u32(alpha, 2));
+        alpha = vorrq_u32(alpha, vshlq_n_u32(alpha, 4));
+
+        uint32x4_t out = vandq_u32(vshrq_n_u32(pixels, 2), mask0);
+        out = vorrq_u32(out, vandq_u32(vshrq_n_u32(pixels, 4), mask1));
+        out = vorrq_u32(out, vandq_u32(vshrq_n_u32(pixels, 6), mask2));
+        out = vorrq_u32(out, vshlq_n_u32(alpha, 24));
+        vst1q_u8(dst + x * 4, vreinterpretq_u8_u32(out));
+    }
+
+    convert_2101010_scalar(dst + x * 4, src + x * 4, width - x);
+}
+
+#endif
+
+static const Owl_Convert_Row_Func row_funcs[OWL_CONVERT_IMPL_COUNT][OWL_CONVERT_COUNT] = {
+    [OWL_CONVERT_IMPL_SCALAR] = {
+        [OWL_CONVERT_888_TO_8888] = convert_888_scalar,
+        [OWL_CONVERT_2101010_TO_8888] = convert_2101010_scalar,
+    },
+#ifdef OWL_CONVERT_X86
+    [OWL_CONVERT_IMPL_SSE2] = {
+        [OWL_CONVERT_888_TO_8888] = convert_888_sse2,
+        [OWL_CONVERT_2101010_TO_8888] = convert_2101010_sse2,
+    },
+    [OWL_CONVERT_IMPL_AVX2] = {
+        [OWL_CONVERT_888_TO_8888] = convert_888_avx2,
+        [OWL_CONVERT_2101010_TO_8888] = convert_2101010_avx2,
+    },
+#endif
+#if defined(__ARM_NEON)
+    [OWL_CONVERT_IMPL_NEON] = {
+        [OWL_CONVERT_888_TO_8888] = convert_888_neon,
+        [OWL_CONVERT_2101010_TO_8888] = convert_2101010_neon,
+    },
+#endif
+};
+
+bool owl_convert_impl_available(Owl_Convert_Impl impl) {
+    switch (impl) {
+    case OWL_CONVERT_IMPL_SCALAR:
+        return true;
+#ifdef OWL_CONVERT_X86
+    case OWL_CONVERT_IMPL_SSE2:
+        return __builtin_cpu_supports("sse2");
+    case OWL_CONVERT_IMPL_AVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+#if defined(__ARM_NEON)
+    case OWL_CONVERT_IMPL_NEON:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+const char* owl_convert_impl_name(Owl_Convert_Impl impl) {
+    switch (impl) {
+    case OWL_CONVERT_IMPL_SCALAR: return "scalar";
+    case OWL_CONVERT_IMPL_SSE2: return "sse2";
+    case OWL_CONVERT_IMPL_AVX2: return "avx2";
+    case OWL_CONVERT_IMPL_NEON: return "neon";
+    default: return "unknown";
+    }
+}
+
+const char* owl_convert_kind_name(Owl_Convert_Kind kind) {
+    switch (kind) {
+    case OWL_CONVERT_888_TO_8888: return "888->8888";
+    case OWL_CONVERT_2101010_TO_8888: return "2101010->8888";
+    default: return "none";
+    }
+}
+
+Owl_Convert_Impl owl_convert_best_impl(void) {
+    static bool selected = false;
+    static Owl_Convert_Impl best = OWL_CONVERT_IMPL_SCALAR;
+
+    if (!selected) {
+        for (int impl = OWL_CONVERT_IMPL_COUNT - 1; impl > OWL_CONVERT_IMPL_SCALAR; impl--) {
+            if (owl_convert_impl_available(impl)) {
+                best = impl;
+                break;
+            }
+        }
+        selected = true;
+    }
+    return best;
+}
+
+Owl_Convert_Row_Func owl_convert_get_row_func(Owl_Convert_Kind kind, Owl_Convert_Impl impl) {
+    if (kind <= OWL_CONVERT_NONE || kind >= OWL_CONVERT_COUNT ||
+        impl < 0 || impl >= OWL_CONVERT_IMPL_COUNT || !owl_convert_impl_available(impl)) {
+        return NULL;
+    }
+    return row_funcs[impl][kind];
+}
+
+int owl_convert_src_bytes_per_pixel(Owl_Convert_Kind kind) {
+    return kind == OWL_CONVERT_888_TO_8888 ? 3 : 4;
+}
+
+void owl_convert_rows(Owl_Convert_Kind kind, uint8_t* dst, int32_t dst_stride,
+                      const uint8_t* src, int32_t src_stride, int32_t width, int32_t rows) {
+    Owl_Convert_Row_Func convert = owl_convert_get_row_func(kind, owl_convert_best_impl());
+    if (!convert) {
+        return;
+    }
+
+    for (int32_t row = 0; row < rows; row++) {
+        convert(dst + (size_t)row * dst_stride, src + (size_t)row * src_stride, width);
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef OWL_CONVERT_H
+#define OWL_CONVERT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    OWL_CONVERT_NONE,
+    OWL_CONVERT_888_TO_8888,
+    OWL_CONVERT_2101010_TO_8888,
+    OWL_CONVERT_COUNT,
+} Owl_Convert_Kind;
+
+typedef enum {
+    OWL_CONVERT_IMPL_SCALAR,
+    OWL_CONVERT_IMPL_SSE2,
+    OWL_CONVERT_IMPL_AVX2,
+    OWL_CONVERT_IMPL_NEON,
+    OWL_CONVERT_IMPL_COUNT,
+} Owl_Convert_Impl;
+
+typedef void (*Owl_Convert_Row_Func)(uint8_t* dst, const uint8_t* src, int32_t width);
+
+bool owl_convert_impl_available(Owl_Convert_Impl impl);
+const char* owl_convert_impl_name(Owl_Convert_Impl impl);
+const char* owl_convert_kind_name(Owl_Convert_Kind kind);
+Owl_Convert_Impl owl_convert_best_impl(void);
+Owl_Convert_Row_Func owl_convert_get_row_func(Owl_Convert_Kind kind, Owl_Convert_Impl impl);
+
+int owl_convert_src_bytes_per_pixel(Owl_Convert_Kind kind);
+void owl_convert_rows(Owl_Convert_Kind kind, uint8_t* dst, int32_t dst_stride,
+                      const uint8_t* src, int32_t src_stride, int32_t width, int32_t rows);
+
+#endif
@@ -0,0 +1,612 @@
+#define _GNU_SOURCE
+#include "internal.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+#include <gbm.h>
+
+#define XCURSOR_MAGIC 0x72756358
+#define XCURSOR_IMAGE_TYPE 0xfffd0002
+#define XCURSOR_MAX_DIMENSION 0x7fff
+#define XCURSOR_MAX_FILE_SIZE (16 * 1024 * 1024)
+#define CURSOR_THEME_MAX_DEPTH 4
+#define CURSOR_DEFAULT_SIZE 24
+#define CURSOR_DEFAULT_PATH "~/.local/share/icons:~/.icons:/usr/share/icons:/usr/share/pixmaps"
+
+static FILE* cursor_log = NULL;
+static void cursor_debug(const char* fmt, ...) {
+    if (!cursor_log) cursor_log = fopen("/tmp/owl_cursor.log", "w");
+    if (cursor_log) {
+        va_list args;
+        va_start(args, fmt);
+        vfprintf(cursor_log, fmt, args);
+        va_end(args);
+        fflush(cursor_log);
+    }
+}
+
+static const char* preloaded_cursors[] = {
+    "default", "text", "pointer", "wait", "progress", "crosshair", "move",
+    "grabbing", "not-allowed", "n-resize", "s-resize", "e-resize", "w-resize",
+    "ne-resize", "nw-resize", "se-resize", "sw-resize", "ew-resize", "ns-resize",
+};
+
+static const struct {
+    const char* name;
+    const char* legacy;
+} cursor_aliases[] = {
+    { "default", "left_ptr" },
+    { "text", "xterm" },
+    { "pointer", "hand2" },
+    { "wait", "watch" },
+    { "progress", "left_ptr_watch" },
+    { "crosshair", "cross" },
+    { "move", "fleur" },
+    { "grabbing", "fleur" },
+    { "not-allowed", "crossed_circle" },
+    { "n-resize", "top_side" },
+    { "s-resize", "bottom_side" },
+    { "e-resize", "right_side" },
+    { "w-resize", "left_side" },
+    { "ne-resize", "top_right_corner" },
+    { "nw-resize", "top_left_corner" },
+    { "se-resize", "bottom_right_corner" },
+    { "sw-resize", "bottom_left_corner" },
+    { "ew-resize", "sb_h_double_arrow" },
+    { "ns-resize", "sb_v_double_arrow" },
+};
+
+static uint32_t read_u32(const uint8_t* data) {
+    return (uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+           ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static uint8_t* read_file(const char* path, size_t* size) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return NULL;
+    }
+
+    uint8_t* data = NULL;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        long length = ftell(file);
+        if (length > 0 && length <= XCURSOR_MAX_FILE_SIZE && fseek(file, 0, SEEK_SET) == 0) {
+            data = malloc(length);
+            if (data && fread(data, 1, length, file) != (size_t)length) {
+                free(data);
+                data = NULL;
+            }
+            *size = length;
+        }
+    }
+
+    fclose(file);
+    return data;
+}
+
+static bool parse_xcursor(const uint8_t* data, size_t size, Owl_Cursor* cursor, uint32_t*** pixels) {
+    if (size < 16 || read_u32(data) != XCURSOR_MAGIC) {
+        return false;
+    }
+
+    uint32_t header_size = read_u32(data + 4);
+    uint32_t toc_count = read_u32(data + 12);
+    if (header_size < 16 || header_size > size || toc_count > (size - header_size) / 12) {
+        return false;
+    }
+
+    cursor->images = calloc(toc_count ? toc_count : 1, sizeof(Owl_Cursor_Image));
+    *pixels = calloc(toc_count ? toc_count : 1, sizeof(uint32_t*));
+    if (!cursor->images || !*pixels) {
+        return false;
+    }
+
+    for (uint32_t index = 0; index < toc_count; index++) {
+        const uint8_t* entry = data + header_size + index * 12;
+        if (read_u32(entry) != XCURSOR_IMAGE_TYPE) {
+            continue;
+        }
+
+        uint32_t position = read_u32(entry + 8);
+        if (position > size || size - position < 36) {
+            continue;
+        }
+
+        const uint8_t* chunk = data + position;
+        uint32_t width = read_u32(chunk + 16);
+        uint32_t height = read_u32(chunk + 20);
+        uint32_t hotspot_x = read_u32(chunk + 24);
+        uint32_t hotspot_y = read_u32(chunk + 28);
+        if (read_u32(chunk + 4) != XCURSOR_IMAGE_TYPE || width == 0 || height == 0 ||
+            width > XCURSOR_MAX_DIMENSION || height > XCURSOR_MAX_DIMENSION ||
+            hotspot_x > width || hotspot_y > height ||
+            (size - position - 36) / 4 / width < height) {
+            continue;
+        }
+
+        uint32_t* image_pixels = malloc((size_t)width * height * 4);
+        if (!image_pixels) {
+            continue;
+        }
+        for (size_t pixel = 0; pixel < (size_t)width * height; pixel++) {
+            image_pixels[pixel] = read_u32(chunk + 36 + pixel * 4);
+        }
+
+        Owl_Cursor_Image* image = &cursor->images[cursor->image_count];
+        image->width = width;
+        image->height = height;
+        image->hotspot_x = hotspot_x;
+        image->hotspot_y = hotspot_y;
+        image->nominal_size = read_u32(chunk + 8);
+        image->delay = read_u32(chunk + 32);
+        (*pixels)[cursor->image_count] = image_pixels;
+        cursor->image_count++;
+    }
+
+    return cursor->image_count > 0;
+}
+
+static void sort_images_by_size(Owl_Cursor* cursor, uint32_t** pixels) {
+    for (int index = 1; index < cursor->image_count; index++) {
+        Owl_Cursor_Image image = cursor->images[index];
+        uint32_t* image_pixels = pixels[index];
+        int position = index;
+        while (position > 0 && cursor->images[position - 1].nominal_size > image.nominal_size) {
+            cursor->images[position] = cursor->images[position - 1];
+            pixels[position] = pixels[position - 1];
+            position--;
+        }
+        cursor->images[position] = image;
+        pixels[position] = image_pixels;
+    }
+}
+
+static void select_size(Owl_Cursor* cursor, int size) {
+    uint32_t best = cursor->images[0].nominal_size;
+    for (int index = 0; index < cursor->image_count; index++) {
+        uint32_t nominal = cursor->images[index].nominal_size;
+        if (abs((int)nominal - size) < abs((int)best - size)) {
+            best = nominal;
+        }
+    }
+
+    cursor->frame_first = -1;
+    cursor->frame_count = 0;
+    for (int index = 0; index < cursor->image_count; index++) {
+        if (cursor->images[index].nominal_size == best) {
+            if (cursor->frame_first < 0) {
+                cursor->frame_first = index;
+            }
+            cursor->frame_count++;
+        }
+    }
+}
+
+static struct gbm_bo* create_hw_cursor_bo(Owl_Display* display, const uint32_t* pixels,
+                                          int32_t width, int32_t height) {
+    if (!display->hw_cursor_supported ||
+        (uint32_t)width > display->hw_cursor_width || (uint32_t)height > display->hw_cursor_height) {
+        return NULL;
+    }
+
+    struct gbm_bo* bo = gbm_bo_create(display->gbm_device,
+                                      display->hw_cursor_width, display->hw_cursor_height,
+                                      GBM_FORMAT_ARGB8888, GBM_BO_USE_CURSOR | GBM_BO_USE_WRITE);
+    if (!bo) {
+        return NULL;
+    }
+
+    size_t padded_size = (size_t)display->hw_cursor_width * display->hw_cursor_height;
+    uint32_t* padded = calloc(padded_size, sizeof(uint32_t));
+    if (!padded) {
+        gbm_bo_destroy(bo);
+        return NULL;
+    }
+
+    for (int32_t row = 0; row < height; row++) {
+        memcpy(padded + (size_t)row * display->hw_cursor_width, pixels + (size_t)row * width,
+               (size_t)width * sizeof(uint32_t));
+    }
+
+    if (gbm_bo_write(bo, padded, padded_size * sizeof(uint32_t)) != 0) {
+        gbm_bo_destroy(bo);
+        bo = NULL;
+    }
+
+    free(padded);
+    return bo;
+}
+
+static void upload_cursor(Owl_Display* display, Owl_Cursor* cursor, uint32_t** pixels) {
+    for (int index = 0; index < cursor->image_count; index++) {
+        Owl_Cursor_Image* image = &cursor->images[index];
+        image->texture_id = owl_render_create_texture(display, pixels[index],
+                                                      image->width, image->height, &image->shader);
+        image->bo = create_hw_cursor_bo(display, pixels[index], image->width, image->height);
+    }
+}
+
+static void destroy_cursor(Owl_Display* display, Owl_Cursor* cursor) {
+    for (int index = 0; index < cursor->image_count; index++) {
+        owl_render_destroy_texture(display, cursor->images[index].texture_id);
+        if (cursor->images[index].bo) {
+            gbm_bo_destroy(cursor->images[index].bo);
+        }
+    }
+    wl_list_remove(&cursor->link);
+    free(cursor->images);
+    free(cursor->name);
+    free(cursor);
+}
+
+static char* expand_home(const char* directory, size_t length) {
+    const char* home = getenv("HOME");
+    char* path = NULL;
+    if (length > 0 && directory[0] == '~') {
+        if (!home) {
+            return NULL;
+        }
+        if (asprintf(&path, "%s%.*s", home, (int)length - 1, directory + 1) < 0) {
+            return NULL;
+        }
+    } else if (asprintf(&path, "%.*s", (int)length, directory) < 0) {
+        return NULL;
+    }
+    return path;
+}
+
+static char* find_in_theme(const char* theme, const char* name, int depth) {
+    const char* search_path = getenv("XCURSOR_PATH");
+    if (!search_path || !*search_path) {
+        search_path = CURSOR_DEFAULT_PATH;
+    }
+
+    char* inherits = NULL;
+    const char* cursor = search_path;
+    while (*cursor) {
+        size_t length = strcspn(cursor, ":");
+        char* directory = expand_home(cursor, length);
+        cursor += length;
+        if (*cursor == ':') {
+            cursor++;
+        }
+        if (!directory) {
+            continue;
+        }
+
+        char* path = NULL;
+        if (asprintf(&path, "%s/%s/cursors/%s", directory, theme, name) >= 0) {
+            if (access(path, R_OK) == 0) {
+                free(directory);
+                free(inherits);
+                return path;
+            }
+            free(path);
+        }
+
+        if (!inherits && asprintf(&path, "%s/%s/index.theme", directory, theme) >= 0) {
+            FILE* index = fopen(path, "r");
+            if (index) {
+                char line[512];
+                while (fgets(line, sizeof(line), index)) {
+                    if (strncasecmp(line, "Inherits", 8) == 0 && strchr(line, '=')) {
+                        inherits = strdup(strchr(line, '=') + 1);
+                        break;
+                    }
+                }
+                fclose(index);
+            }
+            free(path);
+        }
+        free(directory);
+    }
+
+    char* found = NULL;
+    if (inherits && depth < CURSOR_THEME_MAX_DEPTH) {
+        char* saveptr = NULL;
+        for (char* parent = strtok_r(inherits, ",; \t\r\n", &saveptr); parent && !found;
+             parent = strtok_r(NULL, ",; \t\r\n", &saveptr)) {
+            if (strcmp(parent, theme) != 0) {
+                found = find_in_theme(parent, name, depth + 1);
+            }
+        }
+    }
+
+    free(inherits);
+    return found;
+}
+
+static char* find_cursor_file(Owl_Display* display, const char* name) {
+    const char* candidates[2] = { name, NULL };
+    for (size_t index = 0; index < sizeof(cursor_aliases) / sizeof(cursor_aliases[0]); index++) {
+        if (strcmp(cursor_aliases[index].name, name) == 0) {
+            candidates[1] = cursor_aliases[index].legacy;
+            break;
+        }
+    }
+
+    const char* themes[2] = { display->cursor_theme, "default" };
+    for (int theme = 0; theme < 2; theme++) {
+        if (!themes[theme] || (theme == 1 && strcmp(themes[0], "default") == 0)) {
+            continue;
+        }
+        for (int candidate = 0; candidate < 2 && candidates[candidate]; candidate++) {
+            char* path = find_in_theme(themes[theme], candidates[candidate], 0);
+            if (path) {
+                return path;
+            }
+        }
+    }
+    return NULL;
+}
+
+static bool build_fallback_arrow(Owl_Cursor* cursor, uint32_t*** pixels) {
+    const int32_t width = 12;
+    const int32_t height = 19;
+
+    cursor->images = calloc(1, sizeof(Owl_Cursor_Image));
+    *pixels = calloc(1, sizeof(uint32_t*));
+    uint32_t* arrow = calloc((size_t)width * height, sizeof(uint32_t));
+    if (!cursor->images || !*pixels || !arrow) {
+        free(arrow);
+        return false;
+    }
+
+    for (int32_t y = 0; y < height; y++) {
+        int32_t extent = y < 12 ? y : 11 - (y - 12) * 2;
+        for (int32_t x = 0; x <= extent && x < width; x++) {
+            bool edge = x == 0 || x == extent || y == height - 1 || (y >= 12 && x >= extent - 1);
+            arrow[y * width + x] = edge ? 0xFF000000 : 0xFFFFFFFF;
+        }
+    }
+
+    cursor->images[0].width = width;
+    cursor->images[0].height = height;
+    cursor->images[0].nominal_size = height;
+    (*pixels)[0] = arrow;
+    cursor->image_count = 1;
+    return true;
+}
+
+static Owl_Cursor* load_cursor(Owl_Display* display, const char* name) {
+    Owl_Cursor* cursor;
+    wl_list_for_each(cursor, &display->cursors, link) {
+        if (strcmp(cursor->name, name) == 0) {
+            return cursor;
+        }
+    }
+
+    cursor = calloc(1, sizeof(Owl_Cursor));
+    if (!cursor) {
+        return NULL;
+    }
+    cursor->name = strdup(name);
+
+    uint32_t** pixels = NULL;
+    bool loaded = false;
+
+    char* path = find_cursor_file(display, name);
+    if (path) {
+        size_t size = 0;
+        uint8_t* data = read_file(path, &size);
+        if (data) {
+            loaded = parse_xcursor(data, size, cursor, &pixels);
+            free(data);
+        }
+        cursor_debug("cursor %s: %s (%d images)\n", name, path, cursor->image_count);
+        free(path);
+    }
+
+    if (!loaded && strcmp(name, "default") == 0) {
+        free(cursor->images);
+        free(pixels);
+        cursor->images = NULL;
+        pixels = NULL;
+        cursor->image_count = 0;
+        loaded = build_fallback_arrow(cursor, &pixels);
+    }
+
+    if (!loaded || !cursor->name) {
+        for (int index = 0; pixels && index < cursor->image_count; index++) {
+            free(pixels[index]);
+        }
+        free(pixels);
+        free(cursor->images);
+        free(cursor->name);
+        free(cursor);
+        return NULL;
+    }
+
+    sort_images_by_size(cursor, pixels);
+    select_size(cursor, display->cursor_size);
+    upload_cursor(display, cursor, pixels);
+
+    for (int index = 0; index < cursor->image_count; index++) {
+        free(pixels[index]);
+    }
+    free(pixels);
+
+    wl_list_insert(&display->cursors, &cursor->link);
+    return cursor;
+}
+
+static void hide_hw_cursor(Owl_Display* display) {
+    if (!display->hw_cursor_visible) {
+        return;
+    }
+
+    for (int index = 0; index < display->output_count; index++) {
+        drmModeSetCursor(display->drm_fd, display->outputs[index]->drm_crtc_id, 0, 0, 0);
+    }
+    display->hw_cursor_visible = false;
+    display->hw_cursor_bo = NULL;
+}
+
+static bool show_hw_cursor(Owl_Display* display, Owl_Cursor_Image* image) {
+    if (!image->bo) {
+        return false;
+    }
+
+    uint32_t handle = gbm_bo_get_handle(image->bo).u32;
+    for (int index = 0; index < display->output_count; index++) {
+        Owl_Output* output = display->outputs[index];
+        if (image->bo != display->hw_cursor_bo &&
+            drmModeSetCursor2(display->drm_fd, output->drm_crtc_id, handle,
+                              display->hw_cursor_width, display->hw_cursor_height,
+                              image->hotspot_x, image->hotspot_y) != 0) {
+            fprintf(stderr, "owl: hardware cursor unavailable, falling back to composited cursor\n");
+            display->hw_cursor_supported = false;
+            display->hw_cursor_visible = true;
+            hide_hw_cursor(display);
+            return false;
+        }
+        drmModeMoveCursor(display->drm_fd, output->drm_crtc_id,
+                          (int)display->pointer_x - output->pos_x - image->hotspot_x,
+                          (int)display->pointer_y - output->pos_y - image->hotspot_y);
+    }
+
+    display->hw_cursor_bo = image->bo;
+    display->hw_cursor_visible = true;
+    return true;
+}
+
+Owl_Cursor_Image* owl_cursor_current_image(Owl_Display* display) {
+    Owl_Cursor* cursor = display->cursor;
+    if (display->cursor_client_set || !cursor || cursor->frame_count == 0) {
+        return NULL;
+    }
+    return &cursor->images[cursor->frame_first + display->cursor_frame % cursor->frame_count];
+}
+
+void owl_cursor_update(Owl_Display* display) {
+    Owl_Cursor_Image* image = owl_cursor_current_image(display);
+    if (!image || !display->hw_cursor_supported || !show_hw_cursor(display, image)) {
+        hide_hw_cursor(display);
+    }
+    owl_display_damage_cursor(display, false);
+}
+
+static void arm_animation(Owl_Display* display) {
+    Owl_Cursor_Image* image = owl_cursor_current_image(display);
+    if (display->cursor_timer) {
+        uint32_t delay = image && display->cursor->frame_count > 1 ? image->delay : 0;
+        wl_event_source_timer_update(display->cursor_timer, delay > 0 ? (int)delay : 0);
+    }
+}
+
+static int handle_cursor_timer(void* data) {
+    Owl_Display* display = data;
+    display->cursor_frame++;
+    owl_cursor_update(display);
+    owl_display_damage_cursor(display, true);
+    arm_animation(display);
+    return 0;
+}
+
+static void preload_cursors(Owl_Display* display) {
+    for (size_t index = 0; index < sizeof(preloaded_cursors) / sizeof(preloaded_cursors[0]); index++) {
+        load_cursor(display, preloaded_cursors[index]);
+    }
+}
+
+void owl_cursor_init(Owl_Display* display) {
+    wl_list_init(&display->cursors);
+
+    const char* theme = getenv("XCURSOR_THEME");
+    const char* size = getenv("XCURSOR_SIZE");
+    display->cursor_theme = strdup(theme && *theme ? theme : "default");
+    display->cursor_size = size && atoi(size) > 0 ? atoi(size) : CURSOR_DEFAULT_SIZE;
+
+    uint64_t cap_width = 64;
+    uint64_t cap_height = 64;
+    drmGetCap(display->drm_fd, DRM_CAP_CURSOR_WIDTH, &cap_width);
+    drmGetCap(display->drm_fd, DRM_CAP_CURSOR_HEIGHT, &cap_height);
+    display->hw_cursor_width = (uint32_t)cap_width;
+    display->hw_cursor_height = (uint32_t)cap_height;
+    display->hw_cursor_supported = display->gbm_device && !getenv("OWL_NO_HARDWARE_CURSOR");
+
+    display->cursor_timer = wl_event_loop_add_timer(display->event_loop, handle_cursor_timer, display);
+
+    preload_cursors(display);
+    owl_display_set_cursor(display, "default");
+
+    fprintf(stderr, "owl: cursor theme %s size %d\n", display->cursor_theme, display->cursor_size);
+}
+
+void owl_cursor_cleanup(Owl_Display* display) {
+    hide_hw_cursor(display);
+
+    if (display->cursor_timer) {
+        wl_event_source_remove(display->cursor_timer);
+        display->cursor_timer = NULL;
+    }
+
+    Owl_Cursor* cursor;
+    Owl_Cursor* tmp;
+    wl_list_for_each_safe(cursor, tmp, &display->cursors, link) {
+        destroy_cursor(display, cursor);
+    }
+    display->cursor = NULL;
+
+    free(display->cursor_theme);
+    display->cursor_theme = NULL;
+}
+
+bool owl_display_set_cursor(Owl_Display* display, const char* name) {
+    if (!display || !name) {
+        return false;
+    }
+
+    Owl_Cursor* cursor = load_cursor(display, name);
+    if (!cursor) {
+        return false;
+    }
+
+    if (cursor != display->cursor) {
+        display->cursor = cursor;
+        display->cursor_frame = 0;
+        owl_cursor_update(display);
+        owl_display_damage_cursor(display, true);
+        arm_animation(display);
+    }
+    return true;
+}
+
+bool owl_display_set_cursor_theme(Owl_Display* display, const char* theme, int size) {
+    if (!display) {
+        return false;
+    }
+
+    char* name = display->cursor ? strdup(display->cursor->name) : strdup("default");
+    char* theme_name = strdup(theme ? theme : "default");
+    if (!name || !theme_name) {
+        free(name);
+        free(theme_name);
+        return false;
+    }
+
+    hide_hw_cursor(display);
+    display->cursor = NULL;
+
+    Owl_Cursor* cursor;
+    Owl_Cursor* tmp;
+    wl_list_for_each_safe(cursor, tmp, &display->cursors, link) {
+        destroy_cursor(display, cursor);
+    }
+
+    free(display->cursor_theme);
+    display->cursor_theme = theme_name;
+    if (size > 0) {
+        display->cursor_size = size;
+    }
+
+    preload_cursors(display);
+    bool found = owl_display_set_cursor(display, name) || owl_display_set_cursor(display, "default");
+    free(name);
+    return found;
+}
@@ -25,29 +25,6 @@ static void disp_debug(const char* fmt, ...) {
     }
 }
 
-static void client_destroyed(struct wl_listener* listener, void* data) {
-    (void)data;
-    disp_debug("client destroyed\n");
-    wl_list_remove(&listener->link);
-    free(listener);
-}
-
-static void client_created(struct wl_listener* listener, void* data) {
-    (void)listener;
-    struct wl_client* client = data;
-    disp_debug("client connected: %p\n", (void*)client);
-
-    struct wl_listener* destroy_listener = malloc(sizeof(struct wl_listener));
-    if (destroy_listener) {
-        destroy_listener->notify = client_destroyed;
-        wl_client_add_destroy_listener(client, destroy_listener);
-    }
-}
-
-static struct wl_listener client_created_listener = {
-    .notify = client_created,
-};
-
 static int open_drm_device(void) {
     const char* drm_paths[] = {
         "/dev/dri/card0",
@@ -88,6 +65,23 @@ static bool init_gbm(Owl_Display* display) {
     return true;
 }
 
+bool owl_has_extension(const char* extensions, const char* name) {
+    if (!extensions) {
+        return false;
+    }
+
+    size_t length = strlen(name);
+    const char* cursor = extensions;
+    while ((cursor = strstr(cursor, name)) != NULL) {
+        if ((cursor == extensions || cursor[-1] == ' ') &&
+            (cursor[length] == ' ' || cursor[length] == '\0')) {
+            return true;
+        }
+        cursor += length;
+    }
+    return false;
+}
+
 static PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display_ext = NULL;
 
 static bool init_egl(Owl_Display* display) {
@@ -166,8 +160,8 @@ static void page_flip_handler(int fd, unsigned int sequence, unsigned int tv_sec
         output->current_bo = output->next_bo;
         output->next_bo = NULL;
 
-        if (output->display) {
-            disp_debug("page_flip_handler: triggering re-render\n");
+        if (output->display && output->frame_scheduled) {
+            disp_debug("page_flip_handler: rendering scheduled frame\n");
             owl_render_frame(output->display, output);
         }
     }
@@ -194,6 +188,7 @@ Owl_Display* owl_display_create(void) {
     }
 
     wl_list_init(&display->windows);
+    owl_spatial_init(display);
 
     display->wayland_display = wl_display_create();
     if (!display->wayland_display) {
@@ -240,14 +235,23 @@ Owl_Display* owl_display_create(void) {
         display->event_loop, display->drm_fd,
         WL_EVENT_READABLE, handle_drm_event, display);
 
+    owl_task_init(display);
+    owl_event_source_init(display);
+    owl_layout_init(display);
+    owl_ping_init(display);
+    owl_workspace_init(display);
+    owl_thumbnail_init(display);
+    owl_client_init(display);
     owl_output_init(display);
     owl_input_init(display);
     owl_seat_init(display);
+    owl_relative_pointer_init(display);
+    owl_input_timestamps_init(display);
     owl_surface_init(display);
     owl_xdg_shell_init(display);
     owl_render_init(display);
-
-    wl_display_add_client_created_listener(display->wayland_display, &client_created_listener);
+    owl_dmabuf_init(display);
+    owl_cursor_init(display);
 
     display->running = false;
 
@@ -259,12 +263,24 @@ void owl_display_destroy(Owl_Display* display) {
         return;
     }
 
+    owl_task_cleanup(display);
+    owl_event_source_cleanup(display);
+    owl_layout_cleanup(display);
+    owl_ping_cleanup(display);
+    owl_workspace_cleanup(display);
+    owl_thumbnail_cleanup(display);
+    owl_cursor_cleanup(display);
+    owl_dmabuf_cleanup(display);
     owl_render_cleanup(display);
     owl_xdg_shell_cleanup(display);
     owl_surface_cleanup(display);
+    owl_input_timestamps_cleanup(display);
+    owl_relative_pointer_cleanup(display);
     owl_seat_cleanup(display);
     owl_input_cleanup(display);
+    owl_keybind_cleanup(display);
     owl_output_cleanup(display);
+    owl_client_cleanup(display);
 
     if (display->drm_event_source) {
         wl_event_source_remove(display->drm_event_source);
@@ -291,6 +307,10 @@ void owl_display_destroy(Owl_Display* display) {
         wl_display_destroy(display->wayland_display);
     }
 
+    owl_spatial_cleanup(display);
+    owl_stack_cleanup(display);
+    owl_callbacks_cleanup(display);
+    free(display->window_snapshot);
     free(display);
 }
 
@@ -301,13 +321,14 @@ void owl_display_run(Owl_Display* display) {
 
     display->running = true;
 
-    for (int index = 0; index < display->output_count; index++) {
-        owl_render_frame(display, display->outputs[index]);
-    }
+    owl_display_schedule_frame(display);
 
     while (display->running) {
+        owl_clients_begin_iteration(display);
+        owl_flush_window_events(display);
+        owl_xdg_flush_configures(display);
         wl_display_flush_clients(display->wayland_display);
-        wl_event_loop_dispatch(display->event_loop, -1);
+        wl_event_loop_dispatch(display->event_loop, display->window_event_count ? 0 : -1);
     }
 }
 
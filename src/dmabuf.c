@@ -0,0 +1,512 @@
+#define _GNU_SOURCE
+#include "internal.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <drm_fourcc.h>
+#include <wayland-server-core.h>
+#include <wayland-server-protocol.h>
+#include "linux-dmabuf-unstable-v1-protocol.h"
+#include "linux-dmabuf-unstable-v1-protocol.c"
+
+#define MAX_QUERIED_FORMATS 128
+#define MAX_QUERIED_MODIFIERS 64
+
+typedef struct Owl_Dmabuf_Params {
+    Owl_Display* display;
+    struct wl_resource* resource;
+    int fds[OWL_MAX_DMABUF_PLANES];
+    uint32_t offsets[OWL_MAX_DMABUF_PLANES];
+    uint32_t strides[OWL_MAX_DMABUF_PLANES];
+    uint64_t modifier;
+    bool used;
+} Owl_Dmabuf_Params;
+
+static PFNEGLCREATEIMAGEKHRPROC create_image = NULL;
+static PFNEGLDESTROYIMAGEKHRPROC destroy_image = NULL;
+static PFNEGLQUERYDMABUFFORMATSEXTPROC query_dmabuf_formats = NULL;
+static PFNEGLQUERYDMABUFMODIFIERSEXTPROC query_dmabuf_modifiers = NULL;
+
+static const EGLint plane_attribs[OWL_MAX_DMABUF_PLANES][5] = {
+    { EGL_DMA_BUF_PLANE0_FD_EXT, EGL_DMA_BUF_PLANE0_OFFSET_EXT, EGL_DMA_BUF_PLANE0_PITCH_EXT,
+      EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT, EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT },
+    { EGL_DMA_BUF_PLANE1_FD_EXT, EGL_DMA_BUF_PLANE1_OFFSET_EXT, EGL_DMA_BUF_PLANE1_PITCH_EXT,
+      EGL_DMA_BUF_PLANE1_MODIFIER_LO_EXT, EGL_DMA_BUF_PLANE1_MODIFIER_HI_EXT },
+    { EGL_DMA_BUF_PLANE2_FD_EXT, EGL_DMA_BUF_PLANE2_OFFSET_EXT, EGL_DMA_BUF_PLANE2_PITCH_EXT,
+      EGL_DMA_BUF_PLANE2_MODIFIER_LO_EXT, EGL_DMA_BUF_PLANE2_MODIFIER_HI_EXT },
+    { EGL_DMA_BUF_PLANE3_FD_EXT, EGL_DMA_BUF_PLANE3_OFFSET_EXT, EGL_DMA_BUF_PLANE3_PITCH_EXT,
+      EGL_DMA_BUF_PLANE3_MODIFIER_LO_EXT, EGL_DMA_BUF_PLANE3_MODIFIER_HI_EXT },
+};
+
+static EGLImageKHR import_image(Owl_Display* display, Owl_Dmabuf_Buffer* buffer,
+                                uint32_t drm_format, int32_t width, int32_t height,
+                                int first_plane, int plane_count) {
+    EGLint attribs[6 + OWL_MAX_DMABUF_PLANES * 10 + 1];
+    int count = 0;
+
+    attribs[count++] = EGL_WIDTH;
+    attribs[count++] = width;
+    attribs[count++] = EGL_HEIGHT;
+    attribs[count++] = height;
+    attribs[count++] = EGL_LINUX_DRM_FOURCC_EXT;
+    attribs[count++] = drm_format;
+
+    for (int index = 0; index < plane_count; index++) {
+        int plane = first_plane + index;
+        attribs[count++] = plane_attribs[index][0];
+        attribs[count++] = buffer->fds[plane];
+        attribs[count++] = plane_attribs[index][1];
+        attribs[count++] = buffer->offsets[plane];
+        attribs[count++] = plane_attribs[index][2];
+        attribs[count++] = buffer->strides[plane];
+
+        if (query_dmabuf_modifiers && buffer->modifier != DRM_FORMAT_MOD_INVALID) {
+            attribs[count++] = plane_attribs[index][3];
+            attribs[count++] = (EGLint)(buffer->modifier & 0xffffffff);
+            attribs[count++] = plane_attribs[index][4];
+            attribs[count++] = (EGLint)(buffer->modifier >> 32);
+        }
+    }
+
+    attribs[count++] = EGL_NONE;
+
+    return create_image(display->egl_display, EGL_NO_CONTEXT, EGL_LINUX_DMA_BUF_EXT, NULL, attribs);
+}
+
+static void release_images(Owl_Dmabuf_Buffer* buffer) {
+    for (int index = 0; index < OWL_MAX_PLANES; index++) {
+        if (buffer->images[index]) {
+            destroy_image(buffer->display->egl_display, buffer->images[index]);
+            buffer->images[index] = NULL;
+        }
+    }
+}
+
+static bool import_buffer(Owl_Dmabuf_Buffer* buffer) {
+    const Owl_Format_Info* info = buffer->format_info;
+
+    if (!info->is_yuv || info->plane_count == 1) {
+        uint32_t drm_format = info->is_yuv ? info->planes[0].drm_format : buffer->format;
+        int32_t width = info->is_yuv ? owl_format_min_stride(info, buffer->width) / 4 : buffer->width;
+        buffer->images[0] = import_image(buffer->display, buffer, drm_format,
+                                         width, buffer->height, 0, buffer->plane_count);
+        return buffer->images[0] != EGL_NO_IMAGE_KHR;
+    }
+
+    for (int plane = 0; plane < info->plane_count; plane++) {
+        const Owl_Format_Plane* format_plane = &info->planes[plane];
+        int32_t width = (buffer->width + format_plane->hsub - 1) / format_plane->hsub;
+        int32_t height = owl_format_plane_height(info, plane, buffer->height);
+        buffer->images[plane] = import_image(buffer->display, buffer, format_plane->drm_format,
+                                             width, height, plane, 1);
+        if (buffer->images[plane] == EGL_NO_IMAGE_KHR) {
+            release_images(buffer);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void dmabuf_buffer_destroy_handler(struct wl_resource* resource) {
+    Owl_Dmabuf_Buffer* buffer = wl_resource_get_user_data(resource);
+    if (!buffer) {
+        return;
+    }
+
+    release_images(buffer);
+
+    for (int index = 0; index < buffer->plane_count; index++) {
+        if (buffer->fds[index] >= 0) {
+            close(buffer->fds[index]);
+        }
+    }
+
+    free(buffer);
+}
+
+static void dmabuf_buffer_destroy(struct wl_client* client, struct wl_resource* resource) {
+    (void)client;
+    wl_resource_destroy(resource);
+}
+
+static const struct wl_buffer_interface dmabuf_buffer_interface = {
+    .destroy = dmabuf_buffer_destroy,
+};
+
+Owl_Dmabuf_Buffer* owl_dmabuf_buffer_from_resource(struct wl_resource* resource) {
+    if (!resource || !wl_resource_instance_of(resource, &wl_buffer_interface, &dmabuf_buffer_interface)) {
+        return NULL;
+    }
+    return wl_resource_get_user_data(resource);
+}
+
+static void params_destroy_handler(struct wl_resource* resource) {
+    Owl_Dmabuf_Params* params = wl_resource_get_user_data(resource);
+    if (!params) {
+        return;
+    }
+
+    for (int index = 0; index < OWL_MAX_DMABUF_PLANES; index++) {
+        if (params->fds[index] >= 0) {
+            close(params->fds[index]);
+        }
+    }
+
+    free(params);
+}
+
+static void params_destroy(struct wl_client* client, struct wl_resource* resource) {
+    (void)client;
+    wl_resource_destroy(resource);
+}
+
+static void params_add(struct wl_client* client, struct wl_resource* resource, int32_t fd,
+                       uint32_t plane_idx, uint32_t offset, uint32_t stride,
+                       uint32_t modifier_hi, uint32_t modifier_lo) {
+    (void)client;
+    Owl_Dmabuf_Params* params = wl_resource_get_user_data(resource);
+
+    if (params->used) {
+        close(fd);
+        wl_resource_post_error(resource, ZWP_LINUX_BUFFER_PARAMS_V1_ERROR_ALREADY_USED,
+                               "params was already used to create a wl_buffer");
+        return;
+    }
+
+    if (plane_idx >= OWL_MAX_DMABUF_PLANES) {
+        close(fd);
+        wl_resource_post_error(resource, ZWP_LINUX_BUFFER_PARAMS_V1_ERROR_PLANE_IDX,
+                               "plane index %u is too high", plane_idx);
+        return;
+    }
+
+    if (params->fds[plane_idx] >= 0) {
+        close(fd);
+        wl_resource_post_error(resource, ZWP_LINUX_BUFFER_PARAMS_V1_ERROR_PLANE_SET,
+                               "a dmabuf has already been added for plane %u", plane_idx);
+        return;
+    }
+
+    bool has_planes = false;
+    for (int index = 0; index < OWL_MAX_DMABUF_PLANES; index++) {
+        has_planes |= params->fds[index] >= 0;
+    }
+
+    uint64_t modifier = ((uint64_t)modifier_hi << 32) | modifier_lo;
+    if (has_planes && params->modifier != modifier) {
+        close(fd);
+        wl_resource_post_error(resource, ZWP_LINUX_BUFFER_PARAMS_V1_ERROR_INVALID_FORMAT,
+                               "all planes must use the same modifier");
+        return;
+    }
+
+    params->fds[plane_idx] = fd;
+    params->offsets[plane_idx] = offset;
+    params->strides[plane_idx] = stride;
+    params->modifier = modifier;
+}
+
+static Owl_Dmabuf_Buffer* create_buffer(struct wl_client* client, struct wl_resource* resource,
+                                        uint32_t buffer_id, int32_t width, int32_t height,
+                                        uint32_t format, uint32_t flags, bool* import_failed) {
+    Owl_Dmabuf_Params* params = wl_resource_get_user_data(resource);
+    *import_failed = false;
+
+    if (params->used) {
+        wl_resource_post_error(resource, ZWP_LINUX_BUFFER_PARAMS_V1_ERROR_ALREADY_USED,
+                               "params was already used to create a wl_buffer");
+        return NULL;
+    }
+    params->used = true;
+
+    const Owl_Format_Info* info = owl_format_from_drm(format);
+    if (!info) {
+        wl_resource_post_error(resource, ZWP_LINUX_BUFFER_PARAMS_V1_ERROR_INVALID_FORMAT,
+                               "format 0x%08x is not supported", format);
+        return NULL;
+    }
+
+    if (width <= 0 || height <= 0) {
+        wl_resource_post_error(resource, ZWP_LINUX_BUFFER_PARAMS_V1_ERROR_INVALID_DIMENSIONS,
+                               "invalid size %dx%d", width, height);
+        return NULL;
+    }
+
+    int plane_count = 0;
+    while (plane_count < OWL_MAX_DMABUF_PLANES && params->fds[plane_count] >= 0) {
+        plane_count++;
+    }
+
+    for (int index = plane_count; index < OWL_MAX_DMABUF_PLANES; index++) {
+        if (params->fds[index] >= 0) {
+            wl_resource_post_error(resource, ZWP_LINUX_BUFFER_PARAMS_V1_ERROR_INCOMPLETE,
+                                   "plane %d is missing", plane_count);
+            return NULL;
+        }
+    }
+
+    if (plane_count < info->plane_count || (info->is_yuv && plane_count != info->plane_count)) {
+        wl_resource_post_error(resource, ZWP_LINUX_BUFFER_PARAMS_V1_ERROR_INCOMPLETE,
+                               "format needs %d planes, got %d", info->plane_count, plane_count);
+        return NULL;
+    }
+
+    Owl_Dmabuf_Buffer* buffer = calloc(1, sizeof(Owl_Dmabuf_Buffer));
+    if (!buffer) {
+        wl_resource_post_no_memory(resource);
+        return NULL;
+    }
+
+    buffer->display = params->display;
+    buffer->width = width;
+    buffer->height = height;
+    buffer->format = format;
+    buffer->flags = flags;
+    buffer->format_info = info;
+    buffer->plane_count = plane_count;
+    buffer->modifier = params->modifier;
+
+    for (int index = 0; index < OWL_MAX_DMABUF_PLANES; index++) {
+        buffer->fds[index] = -1;
+    }
+
+    for (int index = 0; index < plane_count; index++) {
+        buffer->fds[index] = params->fds[index];
+        buffer->offsets[index] = params->offsets[index];
+        buffer->strides[index] = params->strides[index];
+        params->fds[index] = -1;
+    }
+
+    if (!import_buffer(buffer)) {
+        fprintf(stderr, "owl: failed to import dmabuf %dx%d format 0x%08x\n", width, height, format);
+        *import_failed = true;
+        for (int index = 0; index < plane_count; index++) {
+            close(buffer->fds[index]);
+        }
+        free(buffer);
+        return NULL;
+    }
+
+    buffer->resource = wl_resource_create(client, &wl_buffer_interface, 1, buffer_id);
+    if (!buffer->resource) {
+        release_images(buffer);
+        for (int index = 0; index < plane_count; index++) {
+            close(buffer->fds[index]);
+        }
+        free(buffer);
+        wl_resource_post_no_memory(resource);
+        return NULL;
+    }
+
+    wl_resource_set_implementation(buffer->resource, &dmabuf_buffer_interface,
+                                   buffer, dmabuf_buffer_destroy_handler);
+
+    return buffer;
+}
+
+static void params_create(struct wl_client* client, struct wl_resource* resource,
+                          int32_t width, int32_t height, uint32_t format, uint32_t flags) {
+    bool import_failed;
+    Owl_Dmabuf_Buffer* buffer = create_buffer(client, resource, 0, width, height, format, flags,
+                                              &import_failed);
+    if (!buffer) {
+        if (import_failed) {
+            zwp_linux_buffer_params_v1_send_failed(resource);
+        }
+        return;
+    }
+
+    zwp_linux_buffer_params_v1_send_created(resource, buffer->resource);
+}
+
+static void params_create_immed(struct wl_client* client, struct wl_resource* resource,
+                                uint32_t buffer_id, int32_t width, int32_t height,
+                                uint32_t format, uint32_t flags) {
+    bool import_failed;
+    Owl_Dmabuf_Buffer* buffer = create_buffer(client, resource, buffer_id, width, height, format, flags,
+                                              &import_failed);
+    if (!buffer && import_failed) {
+        wl_resource_post_error(resource, ZWP_LINUX_BUFFER_PARAMS_V1_ERROR_INVALID_WL_BUFFER,
+                               "importing the supplied dmabufs failed");
+    }
+}
+
+static const struct zwp_linux_buffer_params_v1_interface params_interface = {
+    .destroy = params_destroy,
+    .add = params_add,
+    .create = params_create,
+    .create_immed = params_create_immed,
+};
+
+static void linux_dmabuf_destroy(struct wl_client* client, struct wl_resource* resource) {
+    (void)client;
+    wl_resource_destroy(resource);
+}
+
+static void linux_dmabuf_create_params(struct wl_client* client, struct wl_resource* resource,
+                                       uint32_t params_id) {
+    Owl_Display* display = wl_resource_get_user_data(resource);
+
+    Owl_Dmabuf_Params* params = calloc(1, sizeof(Owl_Dmabuf_Params));
+    if (!params) {
+        wl_resource_post_no_memory(resource);
+        return;
+    }
+
+    params->display = display;
+    params->modifier = DRM_FORMAT_MOD_INVALID;
+    for (int index = 0; index < OWL_MAX_DMABUF_PLANES; index++) {
+        params->fds[index] = -1;
+    }
+
+    uint32_t version = wl_resource_get_version(resource);
+    params->resource = wl_resource_create(client, &zwp_linux_buffer_params_v1_interface, version, params_id);
+    if (!params->resource) {
+        free(params);
+        wl_resource_post_no_memory(resource);
+        return;
+    }
+
+    wl_resource_set_implementation(params->resource, &params_interface, params, params_destroy_handler);
+}
+
+static const struct zwp_linux_dmabuf_v1_interface linux_dmabuf_interface = {
+    .destroy = linux_dmabuf_destroy,
+    .create_params = linux_dmabuf_create_params,
+};
+
+static bool egl_supports_format(const EGLint* formats, EGLint count, uint32_t drm_format) {
+    if (!query_dmabuf_formats) {
+        return true;
+    }
+
+    for (EGLint index = 0; index < count; index++) {
+        if ((uint32_t)formats[index] == drm_format) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void send_modifiers(Owl_Display* display, struct wl_resource* resource,
+                           const Owl_Format_Info* info) {
+    uint32_t version = wl_resource_get_version(resource);
+
+    if (version < 3) {
+        zwp_linux_dmabuf_v1_send_format(resource, info->drm_format);
+        return;
+    }
+
+    zwp_linux_dmabuf_v1_send_modifier(resource, info->drm_format,
+                                      DRM_FORMAT_MOD_INVALID >> 32,
+                                      DRM_FORMAT_MOD_INVALID & 0xffffffff);
+
+    if (info->is_yuv) {
+        zwp_linux_dmabuf_v1_send_modifier(resource, info->drm_format,
+                                          DRM_FORMAT_MOD_LINEAR >> 32,
+                                          DRM_FORMAT_MOD_LINEAR & 0xffffffff);
+        return;
+    }
+
+    if (!query_dmabuf_modifiers) {
+        return;
+    }
+
+    EGLuint64KHR modifiers[MAX_QUERIED_MODIFIERS];
+    EGLBoolean external_only[MAX_QUERIED_MODIFIERS];
+    EGLint count = 0;
+    if (!query_dmabuf_modifiers(display->egl_display, info->drm_format, MAX_QUERIED_MODIFIERS,
+                                modifiers, external_only, &count)) {
+        return;
+    }
+
+    for (EGLint index = 0; index < count; index++) {
+        if (external_only[index] || modifiers[index] == DRM_FORMAT_MOD_INVALID) {
+            continue;
+        }
+        zwp_linux_dmabuf_v1_send_modifier(resource, info->drm_format,
+                                          modifiers[index] >> 32,
+                                          modifiers[index] & 0xffffffff);
+    }
+}
+
+static void linux_dmabuf_bind(struct wl_client* client, void* data, uint32_t version, uint32_t id) {
+    Owl_Display* display = data;
+
+    uint32_t bound_version = version < 3 ? version : 3;
+    struct wl_resource* resource = wl_resource_create(client, &zwp_linux_dmabuf_v1_interface,
+                                                      bound_version, id);
+    if (!resource) {
+        wl_client_post_no_memory(client);
+        return;
+    }
+
+    wl_resource_set_implementation(resource, &linux_dmabuf_interface, display, NULL);
+
+    EGLint formats[MAX_QUERIED_FORMATS];
+    EGLint format_count = 0;
+    if (query_dmabuf_formats &&
+        !query_dmabuf_formats(display->egl_display, MAX_QUERIED_FORMATS, formats, &format_count)) {
+        format_count = 0;
+    }
+
+    const Owl_Format_Info* info;
+    for (int index = 0; (info = owl_format_get(index)) != NULL; index++) {
+        bool supported = true;
+        if (info->is_yuv) {
+            for (int plane = 0; plane < info->plane_count; plane++) {
+                supported &= egl_supports_format(formats, format_count, info->planes[plane].drm_format);
+            }
+        } else {
+            supported = egl_supports_format(formats, format_count, info->drm_format);
+        }
+
+        if (supported) {
+            send_modifiers(display, resource, info);
+        }
+    }
+}
+
+void owl_dmabuf_init(Owl_Display* display) {
+    const char* extensions = eglQueryString(display->egl_display, EGL_EXTENSIONS);
+
+    if (!owl_has_extension(extensions, "EGL_EXT_image_dma_buf_import")) {
+        fprintf(stderr, "owl: EGL_EXT_image_dma_buf_import not supported, linux-dmabuf disabled\n");
+        return;
+    }
+
+    create_image = (PFNEGLCREATEIMAGEKHRPROC)eglGetProcAddress("eglCreateImageKHR");
+    destroy_image = (PFNEGLDESTROYIMAGEKHRPROC)eglGetProcAddress("eglDestroyImageKHR");
+    if (!create_image || !destroy_image) {
+        fprintf(stderr, "owl: eglCreateImageKHR not available, linux-dmabuf disabled\n");
+        return;
+    }
+
+    if (owl_has_extension(extensions, "EGL_EXT_image_dma_buf_import_modifiers")) {
+        query_dmabuf_formats = (PFNEGLQUERYDMABUFFORMATSEXTPROC)
+            eglGetProcAddress("eglQueryDmaBufFormatsEXT");
+        query_dmabuf_modifiers = (PFNEGLQUERYDMABUFMODIFIERSEXTPROC)
+            eglGetProcAddress("eglQueryDmaBufModifiersEXT");
+    }
+
+    display->linux_dmabuf_global = wl_global_create(display->wayland_display,
+        &zwp_linux_dmabuf_v1_interface, 3, display, linux_dmabuf_bind);
+
+    if (!display->linux_dmabuf_global) {
+        fprintf(stderr, "owl: failed to create zwp_linux_dmabuf_v1 global\n");
+        return;
+    }
+
+    fprintf(stderr, "owl: linux-dmabuf initialized\n");
+}
+
+void owl_dmabuf_cleanup(Owl_Display* display) {
+    if (display->linux_dmabuf_global) {
+        wl_global_destroy(display->linux_dmabuf_global);
+        display->linux_dmabuf_global = NULL;
+    }
+}
@@ -0,0 +1,120 @@
+#include "internal.h"
+#include <stdlib.h>
+
+static Owl_Draw_Command* record_command(Owl_Display* display, Owl_Draw_Kind kind,
+                                        int x, int y, int width, int height) {
+    Owl_Output* output = display ? display->recording_output : NULL;
+    if (!output || width <= 0 || height <= 0) {
+        return NULL;
+    }
+
+    Owl_Draw_Command* command = wl_array_add(&output->draw_commands[display->recording_stage],
+                                             sizeof(Owl_Draw_Command));
+    if (!command) {
+        return NULL;
+    }
+
+    *command = (Owl_Draw_Command){
+        .kind = kind,
+        .rect = { x, y, width, height },
+    };
+    return command;
+}
+
+Owl_Texture* owl_texture_create(Owl_Display* display, const uint32_t* argb_pixels, int32_t width, int32_t height) {
+    if (!display || !argb_pixels || width <= 0 || height <= 0) {
+        return NULL;
+    }
+
+    Owl_Texture* texture = calloc(1, sizeof(Owl_Texture));
+    if (!texture) {
+        return NULL;
+    }
+
+    texture->display = display;
+    texture->width = width;
+    texture->height = height;
+    texture->id = owl_render_create_texture(display, argb_pixels, width, height, &texture->shader);
+    if (!texture->id) {
+        free(texture);
+        return NULL;
+    }
+    return texture;
+}
+
+bool owl_texture_update(Owl_Texture* texture, const uint32_t* argb_pixels) {
+    if (!texture || !argb_pixels) {
+        return false;
+    }
+    return owl_render_update_texture(texture->display, texture->id, argb_pixels,
+                                     texture->width, texture->height);
+}
+
+void owl_texture_destroy(Owl_Texture* texture) {
+    if (!texture) {
+        return;
+    }
+    owl_render_destroy_texture(texture->display, texture->id);
+    free(texture);
+}
+
+void owl_draw_rect(Owl_Display* display, int x, int y, int width, int height,
+                   float red, float green, float blue, float alpha) {
+    Owl_Draw_Command* command = record_command(display, OWL_DRAW_RECT, x, y, width, height);
+    if (!command) {
+        return;
+    }
+
+    command->color[0] = red * alpha;
+    command->color[1] = green * alpha;
+    command->color[2] = blue * alpha;
+    command->color[3] = alpha;
+}
+
+void owl_draw_texture(Owl_Display* display, Owl_Texture* texture, int x, int y, int width, int height) {
+    if (!texture) {
+        return;
+    }
+
+    Owl_Draw_Command* command = record_command(display, OWL_DRAW_TEXTURE, x, y, width, height);
+    if (!command) {
+        return;
+    }
+
+    command->texture_id = texture->id;
+    command->shader = texture->shader;
+}
+
+bool owl_draw_window_thumbnail(Owl_Display* display, Owl_Window* window, int x, int y, int width, int height) {
+    bool regenerated = false;
+    if (!display || !display->recording_output || !window || !owl_thumbnail_refresh(window, &regenerated)) {
+        return false;
+    }
+
+    Owl_Draw_Command* command = record_command(display, OWL_DRAW_TEXTURE, x, y, width, height);
+    if (!command) {
+        return false;
+    }
+
+    command->texture_id = window->thumbnail_texture;
+    command->shader = OWL_SHADER_RGBA;
+    if (regenerated) {
+        owl_output_damage(display->recording_output, x, y, width, height);
+    }
+    return true;
+}
+
+void owl_output_add_damage(Owl_Output* output, int x, int y, int width, int height) {
+    if (output && width > 0 && height > 0) {
+        owl_output_damage(output, x, y, width, height);
+    }
+}
+
+void owl_display_add_damage(Owl_Display* display, int x, int y, int width, int height) {
+    if (!display) {
+        return;
+    }
+    for (int index = 0; index < display->output_count; index++) {
+        owl_output_add_damage(display->outputs[index], x, y, width, height);
+    }
+}
@@ -0,0 +1,211 @@
+#include "internal.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+typedef enum {
+    OWL_SOURCE_FD,
+    OWL_SOURCE_TIMER,
+    OWL_SOURCE_IDLE,
+} Owl_Source_Kind;
+
+struct Owl_Event_Source {
+    Owl_Display* display;
+    struct wl_event_source* source;
+    Owl_Source_Kind kind;
+    union {
+        Owl_Fd_Callback fd;
+        Owl_Timer_Callback timer;
+        Owl_Idle_Callback idle;
+    } callback;
+    void* data;
+    uint32_t interval_ms;
+    bool dispatching;
+    bool removed;
+    struct wl_list link;
+};
+
+static uint32_t to_wl_mask(uint32_t mask) {
+    uint32_t wl_mask = 0;
+    if (mask & OWL_EVENT_READABLE) {
+        wl_mask |= WL_EVENT_READABLE;
+    }
+    if (mask & OWL_EVENT_WRITABLE) {
+        wl_mask |= WL_EVENT_WRITABLE;
+    }
+    return wl_mask;
+}
+
+static uint32_t from_wl_mask(uint32_t wl_mask) {
+    uint32_t mask = 0;
+    if (wl_mask & WL_EVENT_READABLE) {
+        mask |= OWL_EVENT_READABLE;
+    }
+    if (wl_mask & WL_EVENT_WRITABLE) {
+        mask |= OWL_EVENT_WRITABLE;
+    }
+    if (wl_mask & WL_EVENT_HANGUP) {
+        mask |= OWL_EVENT_HANGUP;
+    }
+    if (wl_mask & WL_EVENT_ERROR) {
+        mask |= OWL_EVENT_ERROR;
+    }
+    return mask;
+}
+
+static void destroy_source(Owl_Event_Source* source) {
+    if (source->source) {
+        wl_event_source_remove(source->source);
+    }
+    wl_list_remove(&source->link);
+    free(source);
+}
+
+static Owl_Event_Source* create_source(Owl_Display* display, Owl_Source_Kind kind, void* data) {
+    Owl_Event_Source* source = calloc(1, sizeof(Owl_Event_Source));
+    if (!source) {
+        fprintf(stderr, "owl: failed to allocate event source\n");
+        return NULL;
+    }
+    source->display = display;
+    source->kind = kind;
+    source->data = data;
+    wl_list_insert(&display->event_sources, &source->link);
+    return source;
+}
+
+static int handle_fd(int fd, uint32_t mask, void* data) {
+    Owl_Event_Source* source = data;
+    source->dispatching = true;
+    source->callback.fd(source->display, fd, from_wl_mask(mask), source->data);
+    source->dispatching = false;
+    if (source->removed) {
+        destroy_source(source);
+    }
+    return 0;
+}
+
+static int handle_timer(void* data) {
+    Owl_Event_Source* source = data;
+    if (source->interval_ms) {
+        wl_event_source_timer_update(source->source, (int)source->interval_ms);
+    }
+    source->dispatching = true;
+    source->callback.timer(source->display, source->data);
+    source->dispatching = false;
+    if (source->removed) {
+        destroy_source(source);
+    }
+    return 0;
+}
+
+static void handle_idle(void* data) {
+    Owl_Event_Source* source = data;
+    source->source = NULL;
+    if (!source->removed) {
+        source->callback.idle(source->display, source->data);
+    }
+    destroy_source(source);
+}
+
+void owl_event_source_init(Owl_Display* display) {
+    wl_list_init(&display->event_sources);
+}
+
+void owl_event_source_cleanup(Owl_Display* display) {
+    Owl_Event_Source* source;
+    Owl_Event_Source* tmp;
+    wl_list_for_each_safe(source, tmp, &display->event_sources, link) {
+        destroy_source(source);
+    }
+}
+
+Owl_Event_Source* owl_display_add_fd(Owl_Display* display, int fd, uint32_t mask,
+                                     Owl_Fd_Callback callback, void* data) {
+    if (!display || fd < 0 || !callback) {
+        return NULL;
+    }
+
+    Owl_Event_Source* source = create_source(display, OWL_SOURCE_FD, data);
+    if (!source) {
+        return NULL;
+    }
+    source->callback.fd = callback;
+    source->source = wl_event_loop_add_fd(display->event_loop, fd, to_wl_mask(mask), handle_fd, source);
+    if (!source->source) {
+        fprintf(stderr, "owl: failed to add fd %d to event loop\n", fd);
+        destroy_source(source);
+        return NULL;
+    }
+    return source;
+}
+
+Owl_Event_Source* owl_display_add_timer(Owl_Display* display, uint32_t delay_ms, uint32_t interval_ms,
+                                        Owl_Timer_Callback callback, void* data) {
+    if (!display || !callback) {
+        return NULL;
+    }
+
+    Owl_Event_Source* source = create_source(display, OWL_SOURCE_TIMER, data);
+    if (!source) {
+        return NULL;
+    }
+    source->callback.timer = callback;
+    source->source = wl_event_loop_add_timer(display->event_loop, handle_timer, source);
+    if (!source->source) {
+        fprintf(stderr, "owl: failed to add timer to event loop\n");
+        destroy_source(source);
+        return NULL;
+    }
+    owl_event_source_set_timer(source, delay_ms, interval_ms);
+    return source;
+}
+
+Owl_Event_Source* owl_display_add_idle(Owl_Display* display, Owl_Idle_Callback callback, void* data) {
+    if (!display || !callback) {
+        return NULL;
+    }
+
+    Owl_Event_Source* source = create_source(display, OWL_SOURCE_IDLE, data);
+    if (!source) {
+        return NULL;
+    }
+    source->callback.idle = callback;
+    source->source = wl_event_loop_add_idle(display->event_loop, handle_idle, source);
+    if (!source->source) {
+        fprintf(stderr, "owl: failed to add idle callback to event loop\n");
+        destroy_source(source);
+        return NULL;
+    }
+    return source;
+}
+
+bool owl_event_source_set_mask(Owl_Event_Source* source, uint32_t mask) {
+    if (!source || source->kind != OWL_SOURCE_FD || !source->source || source->removed) {
+        return false;
+    }
+    return wl_event_source_fd_update(source->source, to_wl_mask(mask)) == 0;
+}
+
+bool owl_event_source_set_timer(Owl_Event_Source* source, uint32_t delay_ms, uint32_t interval_ms) {
+    if (!source || source->kind != OWL_SOURCE_TIMER || !source->source || source->removed) {
+        return false;
+    }
+
+    source->interval_ms = interval_ms;
+    if (delay_ms == 0 && interval_ms) {
+        delay_ms = interval_ms;
+    }
+    return wl_event_source_timer_update(source->source, (int)delay_ms) == 0;
+}
+
+void owl_event_source_remove(Owl_Event_Source* source) {
+    if (!source || source->removed) {
+        return;
+    }
+
+    if (source->dispatching || (source->kind == OWL_SOURCE_IDLE && !source->source)) {
+        source->removed = true;
+        return;
+    }
+    destroy_source(source);
+}
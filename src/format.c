@@ -0,0 +1,208 @@
+#include "internal.h"
+#include <stddef.h>
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+#include <drm_fourcc.h>
+#include <wayland-server-protocol.h>
+
+#ifndef GL_BGRA_EXT
+#define GL_BGRA_EXT 0x80E1
+#endif
+
+#ifndef GL_UNSIGNED_INT_2_10_10_10_REV_EXT
+#define GL_UNSIGNED_INT_2_10_10_10_REV_EXT 0x8368
+#endif
+
+#ifndef GL_HALF_FLOAT_OES
+#define GL_HALF_FLOAT_OES 0x8D61
+#endif
+
+#define RGB_FORMAT(shm, drm, kind, alpha, format, type, bpp, caps) \
+    { \
+        .shm_format = (shm), \
+        .drm_format = (drm), \
+        .shader = (kind), \
+        .requires = (caps), \
+        .has_alpha = (alpha), \
+        .plane_count = 1, \
+        .planes = { { (format), (type), (drm), (bpp), 1, 1, 1 } }, \
+    }
+
+#define TEN_BIT_FORMAT(shm, drm, kind, alpha) \
+    { \
+        .shm_format = (shm), \
+        .drm_format = (drm), \
+        .shader = (kind), \
+        .requires = OWL_GL_CAP_TYPE_2_10_10_10_REV, \
+        .fallback = { GL_RGBA, GL_UNSIGNED_BYTE, (kind), 0, OWL_CONVERT_2101010_TO_8888 }, \
+        .has_fallback = true, \
+        .has_alpha = (alpha), \
+        .plane_count = 1, \
+        .planes = { { GL_RGBA, GL_UNSIGNED_INT_2_10_10_10_REV_EXT, (drm), 4, 1, 1, 1 } }, \
+    }
+
+#define PACKED_24_FORMAT(shm, drm, kind) \
+    { \
+        .shm_format = (shm), \
+        .drm_format = (drm), \
+        .shader = (kind), \
+        .convert = OWL_CONVERT_888_TO_8888, \
+        .plane_count = 1, \
+        .planes = { { GL_RGBA, GL_UNSIGNED_BYTE, (drm), 3, 1, 1, 1 } }, \
+    }
+
+static const Owl_Format_Info formats[] = {
+    {
+        .shm_format = WL_SHM_FORMAT_ARGB8888,
+        .drm_format = DRM_FORMAT_ARGB8888,
+        .shader = OWL_SHADER_RGBA,
+        .requires = OWL_GL_CAP_BGRA8888,
+        .fallback = { GL_RGBA, GL_UNSIGNED_BYTE, OWL_SHADER_BGRA, 0, OWL_CONVERT_NONE },
+        .has_fallback = true,
+        .has_alpha = true,
+        .plane_count = 1,
+        .planes = {
+            { GL_BGRA_EXT, GL_UNSIGNED_BYTE, DRM_FORMAT_ARGB8888, 4, 1, 1, 1 },
+        },
+    },
+    {
+        .shm_format = WL_SHM_FORMAT_XRGB8888,
+        .drm_format = DRM_FORMAT_XRGB8888,
+        .shader = OWL_SHADER_RGBX,
+        .requires = OWL_GL_CAP_BGRA8888,
+        .fallback = { GL_RGBA, GL_UNSIGNED_BYTE, OWL_SHADER_BGRX, 0, OWL_CONVERT_NONE },
+        .has_fallback = true,
+        .plane_count = 1,
+        .planes = {
+            { GL_BGRA_EXT, GL_UNSIGNED_BYTE, DRM_FORMAT_XRGB8888, 4, 1, 1, 1 },
+        },
+    },
+    RGB_FORMAT(WL_SHM_FORMAT_ABGR8888, DRM_FORMAT_ABGR8888, OWL_SHADER_RGBA, true,
+               GL_RGBA, GL_UNSIGNED_BYTE, 4, 0),
+    RGB_FORMAT(WL_SHM_FORMAT_XBGR8888, DRM_FORMAT_XBGR8888, OWL_SHADER_RGBX, false,
+               GL_RGBA, GL_UNSIGNED_BYTE, 4, 0),
+    RGB_FORMAT(WL_SHM_FORMAT_RGB565, DRM_FORMAT_RGB565, OWL_SHADER_RGBX, false,
+               GL_RGB, GL_UNSIGNED_SHORT_5_6_5, 2, 0),
+    PACKED_24_FORMAT(WL_SHM_FORMAT_RGB888, DRM_FORMAT_RGB888, OWL_SHADER_BGRX),
+    PACKED_24_FORMAT(WL_SHM_FORMAT_BGR888, DRM_FORMAT_BGR888, OWL_SHADER_RGBX),
+    TEN_BIT_FORMAT(WL_SHM_FORMAT_ARGB2101010, DRM_FORMAT_ARGB2101010, OWL_SHADER_BGRA, true),
+    TEN_BIT_FORMAT(WL_SHM_FORMAT_XRGB2101010, DRM_FORMAT_XRGB2101010, OWL_SHADER_BGRX, false),
+    TEN_BIT_FORMAT(WL_SHM_FORMAT_ABGR2101010, DRM_FORMAT_ABGR2101010, OWL_SHADER_RGBA, true),
+    TEN_BIT_FORMAT(WL_SHM_FORMAT_XBGR2101010, DRM_FORMAT_XBGR2101010, OWL_SHADER_RGBX, false),
+    RGB_FORMAT(WL_SHM_FORMAT_ABGR16161616F, DRM_FORMAT_ABGR16161616F, OWL_SHADER_RGBA, true,
+               GL_RGBA, GL_HALF_FLOAT_OES, 8, OWL_GL_CAP_HALF_FLOAT),
+    RGB_FORMAT(WL_SHM_FORMAT_XBGR16161616F, DRM_FORMAT_XBGR16161616F, OWL_SHADER_RGBX, false,
+               GL_RGBA, GL_HALF_FLOAT_OES, 8, OWL_GL_CAP_HALF_FLOAT),
+    {
+        .shm_format = WL_SHM_FORMAT_NV12,
+        .drm_format = DRM_FORMAT_NV12,
+        .shader = OWL_SHADER_NV12,
+        .is_yuv = true,
+        .plane_count = 2,
+        .planes = {
+            { GL_LUMINANCE, GL_UNSIGNED_BYTE, DRM_FORMAT_R8, 1, 1, 1, 1 },
+            { GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, DRM_FORMAT_GR88, 2, 1, 2, 2 },
+        },
+    },
+    {
+        .shm_format = WL_SHM_FORMAT_YUV420,
+        .drm_format = DRM_FORMAT_YUV420,
+        .shader = OWL_SHADER_YUV420,
+        .is_yuv = true,
+        .plane_count = 3,
+        .planes = {
+            { GL_LUMINANCE, GL_UNSIGNED_BYTE, DRM_FORMAT_R8, 1, 1, 1, 1 },
+            { GL_LUMINANCE, GL_UNSIGNED_BYTE, DRM_FORMAT_R8, 1, 1, 2, 2 },
+            { GL_LUMINANCE, GL_UNSIGNED_BYTE, DRM_FORMAT_R8, 1, 1, 2, 2 },
+        },
+    },
+    {
+        .shm_format = WL_SHM_FORMAT_YUYV,
+        .drm_format = DRM_FORMAT_YUYV,
+        .shader = OWL_SHADER_YUYV,
+        .is_yuv = true,
+        .plane_count = 1,
+        .planes = {
+            { GL_RGBA, GL_UNSIGNED_BYTE, DRM_FORMAT_ABGR8888, 4, 2, 1, 1 },
+        },
+    },
+};
+
+#define FORMAT_COUNT (int)(sizeof(formats) / sizeof(formats[0]))
+
+const Owl_Format_Info* owl_format_get(int index) {
+    if (index < 0 || index >= FORMAT_COUNT) {
+        return NULL;
+    }
+    return &formats[index];
+}
+
+bool owl_format_resolve_upload(const Owl_Format_Info* info, uint32_t gl_caps, Owl_Format_Upload* upload) {
+    Owl_Format_Upload native = {
+        .gl_format = info->planes[0].gl_format,
+        .gl_type = info->planes[0].gl_type,
+        .shader = info->shader,
+        .requires = info->requires,
+        .convert = info->convert,
+    };
+
+    const Owl_Format_Upload* chosen = NULL;
+    if ((native.requires & ~gl_caps) == 0) {
+        chosen = &native;
+    } else if (info->has_fallback && (info->fallback.requires & ~gl_caps) == 0) {
+        chosen = &info->fallback;
+    }
+
+    if (!chosen) {
+        return false;
+    }
+    if (upload) {
+        *upload = *chosen;
+    }
+    return true;
+}
+
+Owl_Shader_Kind owl_format_dmabuf_shader(const Owl_Format_Info* info) {
+    if (info->is_yuv) {
+        return info->shader;
+    }
+    return info->has_alpha ? OWL_SHADER_RGBA : OWL_SHADER_RGBX;
+}
+
+const Owl_Format_Info* owl_format_from_shm(uint32_t shm_format) {
+    for (int index = 0; index < FORMAT_COUNT; index++) {
+        if (formats[index].shm_format == shm_format) {
+            return &formats[index];
+        }
+    }
+    return NULL;
+}
+
+const Owl_Format_Info* owl_format_from_drm(uint32_t drm_format) {
+    for (int index = 0; index < FORMAT_COUNT; index++) {
+        if (formats[index].drm_format == drm_format) {
+            return &formats[index];
+        }
+    }
+    return NULL;
+}
+
+int owl_format_min_stride(const Owl_Format_Info* info, int32_t width) {
+    const Owl_Format_Plane* plane = &info->planes[0];
+    int texels = (width + plane->pixels_per_texel - 1) / plane->pixels_per_texel;
+    return texels * plane->bytes_per_texel;
+}
+
+int owl_format_plane_stride(const Owl_Format_Info* info, int plane, int32_t stride) {
+    if (plane == 0) {
+        return stride;
+    }
+    const Owl_Format_Plane* base = &info->planes[0];
+    const Owl_Format_Plane* chroma = &info->planes[plane];
+    return stride * chroma->bytes_per_texel / (base->bytes_per_texel * chroma->hsub);
+}
+
+int owl_format_plane_height(const Owl_Format_Info* info, int plane, int32_t height) {
+    int vsub = info->planes[plane].vsub;
+    return (height + vsub - 1) / vsub;
+}
@@ -0,0 +1,166 @@
+#include "internal.h"
+#include <stdlib.h>
+
+#define GRAB_MIN_SIZE 16
+
+static void place_window(Owl_Window* window, int x, int y) {
+    if (window->pos_x == x && window->pos_y == y) {
+        return;
+    }
+    window->pos_x = x;
+    window->pos_y = y;
+    owl_spatial_update_window(window->display, window);
+    owl_stack_sync(window);
+    owl_display_schedule_frame(window->display);
+}
+
+static void send_resize(Owl_Display* display) {
+    Owl_Window* window = display->grab_window;
+    int width = display->grab_target_width;
+    int height = display->grab_target_height;
+
+    int x = window->pos_x;
+    int y = window->pos_y;
+    if (display->grab_edges & OWL_EDGE_LEFT) {
+        x = display->grab_x + display->grab_width - width;
+    }
+    if (display->grab_edges & OWL_EDGE_TOP) {
+        y = display->grab_y + display->grab_height - height;
+    }
+
+    display->grab_resize_queued = false;
+    owl_xdg_toplevel_schedule_configure(window, width, height);
+    place_window(window, x, y);
+}
+
+static bool begin_grab(Owl_Window* window, Owl_Grab_Mode mode, uint32_t edges) {
+    if (!window || !window->mapped) {
+        return false;
+    }
+
+    Owl_Display* display = window->display;
+    if (display->grab_mode != OWL_GRAB_NONE) {
+        owl_display_end_grab(display);
+    }
+
+    display->grab_mode = mode;
+    display->grab_window = window;
+    display->grab_edges = edges;
+    display->grab_pointer_x = display->pointer_x;
+    display->grab_pointer_y = display->pointer_y;
+    display->grab_x = window->pos_x;
+    display->grab_y = window->pos_y;
+    display->grab_width = window->width;
+    display->grab_height = window->height;
+    display->grab_target_width = window->width;
+    display->grab_target_height = window->height;
+    display->grab_resize_queued = false;
+    owl_seat_set_pointer_focus(display, NULL, 0, 0);
+
+    if (mode == OWL_GRAB_RESIZE) {
+        window->resizing = true;
+        owl_xdg_toplevel_schedule_configure(window, window->width, window->height);
+    }
+    return true;
+}
+
+void owl_grab_motion(Owl_Display* display) {
+    Owl_Window* window = display->grab_window;
+    int dx = (int)(display->pointer_x - display->grab_pointer_x);
+    int dy = (int)(display->pointer_y - display->grab_pointer_y);
+
+    if (display->grab_mode == OWL_GRAB_MOVE) {
+        place_window(window, display->grab_x + dx, display->grab_y + dy);
+        return;
+    }
+
+    int width = display->grab_width;
+    int height = display->grab_height;
+    if (display->grab_edges & OWL_EDGE_LEFT) {
+        width -= dx;
+    } else if (display->grab_edges & OWL_EDGE_RIGHT) {
+        width += dx;
+    }
+    if (display->grab_edges & OWL_EDGE_TOP) {
+        height -= dy;
+    } else if (display->grab_edges & OWL_EDGE_BOTTOM) {
+        height += dy;
+    }
+    width = width < GRAB_MIN_SIZE ? GRAB_MIN_SIZE : width;
+    height = height < GRAB_MIN_SIZE ? GRAB_MIN_SIZE : height;
+
+    if (width == display->grab_target_width && height == display->grab_target_height) {
+        return;
+    }
+    display->grab_target_width = width;
+    display->grab_target_height = height;
+
+    if (window->pending_configure) {
+        display->grab_resize_queued = true;
+        return;
+    }
+    send_resize(display);
+}
+
+void owl_grab_configure_acked(Owl_Window* window) {
+    Owl_Display* display = window->display;
+    if (display->grab_window == window && display->grab_resize_queued && !window->pending_configure) {
+        send_resize(display);
+    }
+}
+
+void owl_grab_window_destroyed(Owl_Window* window) {
+    Owl_Display* display = window->display;
+    if (display->grab_window == window) {
+        display->grab_mode = OWL_GRAB_NONE;
+        display->grab_window = NULL;
+        display->grab_resize_queued = false;
+    }
+}
+
+bool owl_window_begin_move(Owl_Window* window) {
+    return begin_grab(window, OWL_GRAB_MOVE, 0);
+}
+
+bool owl_window_begin_resize(Owl_Window* window, uint32_t edges) {
+    edges &= OWL_EDGE_TOP | OWL_EDGE_BOTTOM | OWL_EDGE_LEFT | OWL_EDGE_RIGHT;
+    if (!edges) {
+        return false;
+    }
+    return begin_grab(window, OWL_GRAB_RESIZE, edges);
+}
+
+void owl_display_end_grab(Owl_Display* display) {
+    if (!display || display->grab_mode == OWL_GRAB_NONE) {
+        return;
+    }
+
+    Owl_Window* window = display->grab_window;
+    Owl_Grab_Mode mode = display->grab_mode;
+    if (mode == OWL_GRAB_RESIZE && display->grab_resize_queued) {
+        send_resize(display);
+    }
+
+    display->grab_mode = OWL_GRAB_NONE;
+    display->grab_window = NULL;
+    display->motion_pending = true;
+
+    if (mode == OWL_GRAB_RESIZE) {
+        window->resizing = false;
+        owl_xdg_toplevel_schedule_configure(window, window->width, window->height);
+        owl_invoke_window_callback(display, OWL_WINDOW_EVENT_RESIZE, window);
+    }
+    if (window->pos_x != display->grab_x || window->pos_y != display->grab_y) {
+        owl_invoke_window_callback(display, OWL_WINDOW_EVENT_MOVE, window);
+    }
+}
+
+void owl_display_deny_grab_request(Owl_Display* display) {
+    if (display) {
+        display->grab_request_denied = true;
+    }
+}
+
+bool owl_display_is_grabbing(Owl_Display* display) {
+    return display && display->grab_mode != OWL_GRAB_NONE;
+}
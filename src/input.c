@@ -8,7 +8,6 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/mman.h>
-#include <time.h>
 #include <libudev.h>
 #include <libinput.h>
 #include <wayland-server-protocol.h>
@@ -36,12 +35,6 @@ typedef struct Owl_Pointer {
     Owl_Display* display;
 } Owl_Pointer;
 
-static uint32_t get_time_ms(void) {
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
-}
-
 static int open_restricted(const char* path, int flags, void* user_data) {
     (void)user_data;
     int fd = open(path, flags);
@@ -63,93 +56,102 @@ static const struct libinput_interface libinput_interface = {
     .close_restricted = close_restricted,
 };
 
+static const uint32_t modifier_flags[4] = { OWL_MOD_SHIFT, OWL_MOD_CTRL, OWL_MOD_ALT, OWL_MOD_SUPER };
+
+static void cache_modifier_indices(Owl_Display* display) {
+    const char* names[4] = { XKB_MOD_NAME_SHIFT, XKB_MOD_NAME_CTRL, XKB_MOD_NAME_ALT, XKB_MOD_NAME_LOGO };
+    for (int index = 0; index < 4; index++) {
+        display->modifier_indices[index] = display->xkb_keymap
+            ? xkb_keymap_mod_get_index(display->xkb_keymap, names[index]) : XKB_MOD_INVALID;
+    }
+}
+
 static void update_modifier_state(Owl_Display* display) {
     if (!display->xkb_state) {
         return;
     }
 
     display->modifier_state = 0;
-
-    if (xkb_state_mod_name_is_active(display->xkb_state, XKB_MOD_NAME_SHIFT, XKB_STATE_MODS_EFFECTIVE)) {
-        display->modifier_state |= OWL_MOD_SHIFT;
-    }
-    if (xkb_state_mod_name_is_active(display->xkb_state, XKB_MOD_NAME_CTRL, XKB_STATE_MODS_EFFECTIVE)) {
-        display->modifier_state |= OWL_MOD_CTRL;
-    }
-    if (xkb_state_mod_name_is_active(display->xkb_state, XKB_MOD_NAME_ALT, XKB_STATE_MODS_EFFECTIVE)) {
-        display->modifier_state |= OWL_MOD_ALT;
+    for (int index = 0; index < 4; index++) {
+        xkb_mod_index_t mod = display->modifier_indices[index];
+        if (mod != XKB_MOD_INVALID &&
+            xkb_state_mod_index_is_active(display->xkb_state, mod, XKB_STATE_MODS_EFFECTIVE) > 0) {
+            display->modifier_state |= modifier_flags[index];
+        }
     }
-    if (xkb_state_mod_name_is_active(display->xkb_state, XKB_MOD_NAME_LOGO, XKB_STATE_MODS_EFFECTIVE)) {
-        display->modifier_state |= OWL_MOD_SUPER;
+}
+
+static void update_pointer_focus(Owl_Display* display, Owl_Window* window) {
+    Owl_Surface* surface = window ? window->surface : NULL;
+
+    if (surface != display->pointer_focus) {
+        double local_x = display->pointer_x - (window ? window->pos_x : 0);
+        double local_y = display->pointer_y - (window ? window->pos_y : 0);
+        owl_seat_set_pointer_focus(display, surface, local_x, local_y);
     }
 }
 
-static void handle_keyboard_key(Owl_Display* display, struct libinput_event_keyboard* event) {
-    uint32_t keycode = libinput_event_keyboard_get_key(event);
-    enum libinput_key_state state = libinput_event_keyboard_get_key_state(event);
+static void reset_relative_motion(Owl_Display* display) {
+    display->motion_dx = 0;
+    display->motion_dy = 0;
+    display->motion_dx_unaccel = 0;
+    display->motion_dy_unaccel = 0;
+}
 
-    if (display->xkb_state) {
-        xkb_state_update_key(display->xkb_state, keycode + 8,
-                            state == LIBINPUT_KEY_STATE_PRESSED ? XKB_KEY_DOWN : XKB_KEY_UP);
-        update_modifier_state(display);
+static void flush_pointer_motion(Owl_Display* display) {
+    if (!display->motion_pending) {
+        return;
+    }
+    display->motion_pending = false;
+    if (display->motion_timer) {
+        wl_event_source_timer_update(display->motion_timer, 0);
     }
 
-    xkb_keysym_t keysym = XKB_KEY_NoSymbol;
-    if (display->xkb_state) {
-        keysym = xkb_state_key_get_one_sym(display->xkb_state, keycode + 8);
+    if (display->grab_mode != OWL_GRAB_NONE) {
+        reset_relative_motion(display);
+        owl_grab_motion(display);
+        owl_cursor_update(display);
+        return;
     }
 
+    Owl_Window* window = owl_spatial_window_at(display, (int)display->pointer_x, (int)display->pointer_y);
+    update_pointer_focus(display, window);
+    owl_cursor_update(display);
+
     struct Owl_Input input = {
-        .keycode = keycode,
-        .keysym = keysym,
+        .keycode = 0,
+        .keysym = 0,
         .modifiers = display->modifier_state,
         .button = 0,
         .pointer_x = (int)display->pointer_x,
         .pointer_y = (int)display->pointer_y,
+        .time_usec = display->motion_time_usec,
     };
 
-    Owl_Input_Event event_type = state == LIBINPUT_KEY_STATE_PRESSED
-        ? OWL_INPUT_KEY_PRESS : OWL_INPUT_KEY_RELEASE;
-
-    owl_invoke_input_callback(display, event_type, &input);
-
-    uint32_t wl_state = state == LIBINPUT_KEY_STATE_PRESSED
-        ? WL_KEYBOARD_KEY_STATE_PRESSED : WL_KEYBOARD_KEY_STATE_RELEASED;
-    owl_seat_send_key(display, keycode, wl_state);
-    owl_seat_send_modifiers(display);
-}
+    owl_invoke_input_callback(display, OWL_INPUT_POINTER_MOTION, &input);
 
-static Owl_Window* find_window_at(Owl_Display* display, int x, int y) {
-    Owl_Window* window;
-    wl_list_for_each(window, &display->windows, link) {
-        if (!window->mapped) {
-            continue;
-        }
-        if (x >= window->pos_x && x < window->pos_x + window->width &&
-            y >= window->pos_y && y < window->pos_y + window->height) {
-            return window;
-        }
+    if (window) {
+        double local_x = display->pointer_x - window->pos_x;
+        double local_y = display->pointer_y - window->pos_y;
+        owl_seat_send_pointer_motion(display, display->motion_time_usec, local_x, local_y);
     }
-    return NULL;
+    reset_relative_motion(display);
 }
 
-static void update_pointer_focus(Owl_Display* display) {
-    int px = (int)display->pointer_x;
-    int py = (int)display->pointer_y;
-
-    Owl_Window* window = find_window_at(display, px, py);
-    Owl_Surface* surface = window ? window->surface : NULL;
-
-    if (surface != display->pointer_focus) {
-        double local_x = px - (window ? window->pos_x : 0);
-        double local_y = py - (window ? window->pos_y : 0);
-        owl_seat_set_pointer_focus(display, surface, local_x, local_y);
-    }
+static int handle_motion_timer(void* data) {
+    flush_pointer_motion(data);
+    return 0;
 }
 
 static void handle_pointer_motion(Owl_Display* display, struct libinput_event_pointer* event) {
     double dx = libinput_event_pointer_get_dx(event);
     double dy = libinput_event_pointer_get_dy(event);
+    uint64_t time_usec = libinput_event_pointer_get_time_usec(event);
+
+    display->motion_dx += dx;
+    display->motion_dy += dy;
+    display->motion_dx_unaccel += libinput_event_pointer_get_dx_unaccelerated(event);
+    display->motion_dy_unaccel += libinput_event_pointer_get_dy_unaccelerated(event);
 
     display->pointer_x += dx;
     display->pointer_y += dy;
@@ -162,30 +164,61 @@ static void handle_pointer_motion(Owl_Display* display, struct libinput_event_po
         if (display->pointer_y >= output->height) display->pointer_y = output->height - 1;
     }
 
-    update_pointer_focus(display);
+    if (!display->motion_pending && display->motion_coalesce_ms && display->motion_timer) {
+        wl_event_source_timer_update(display->motion_timer, (int)display->motion_coalesce_ms);
+    }
+    display->motion_pending = true;
+    display->motion_time_usec = time_usec;
+}
+
+static void handle_keyboard_key(Owl_Display* display, struct libinput_event_keyboard* event) {
+    flush_pointer_motion(display);
+
+    uint32_t keycode = libinput_event_keyboard_get_key(event);
+    enum libinput_key_state state = libinput_event_keyboard_get_key_state(event);
+    uint64_t time_usec = libinput_event_keyboard_get_time_usec(event);
+    bool pressed = state == LIBINPUT_KEY_STATE_PRESSED;
+
+    if (display->xkb_state) {
+        xkb_state_update_key(display->xkb_state, keycode + 8, pressed ? XKB_KEY_DOWN : XKB_KEY_UP);
+        update_modifier_state(display);
+    }
+
+    xkb_keysym_t keysym = XKB_KEY_NoSymbol;
+    if (display->xkb_state) {
+        keysym = xkb_state_key_get_one_sym(display->xkb_state, keycode + 8);
+    }
 
     struct Owl_Input input = {
-        .keycode = 0,
-        .keysym = 0,
+        .keycode = keycode,
+        .keysym = keysym,
         .modifiers = display->modifier_state,
         .button = 0,
         .pointer_x = (int)display->pointer_x,
         .pointer_y = (int)display->pointer_y,
+        .time_usec = time_usec,
     };
 
-    owl_invoke_input_callback(display, OWL_INPUT_POINTER_MOTION, &input);
-
-    Owl_Window* focused_window = find_window_at(display, (int)display->pointer_x, (int)display->pointer_y);
-    if (focused_window) {
-        double local_x = display->pointer_x - focused_window->pos_x;
-        double local_y = display->pointer_y - focused_window->pos_y;
-        owl_seat_send_pointer_motion(display, local_x, local_y);
+    if (owl_keybind_handle(display, keycode, pressed, &input)) {
+        owl_seat_send_modifiers(display);
+        return;
     }
+
+    Owl_Input_Event event_type = pressed ? OWL_INPUT_KEY_PRESS : OWL_INPUT_KEY_RELEASE;
+
+    owl_invoke_input_callback(display, event_type, &input);
+
+    uint32_t wl_state = pressed ? WL_KEYBOARD_KEY_STATE_PRESSED : WL_KEYBOARD_KEY_STATE_RELEASED;
+    owl_seat_send_key(display, time_usec, keycode, wl_state);
+    owl_seat_send_modifiers(display);
 }
 
 static void handle_pointer_button(Owl_Display* display, struct libinput_event_pointer* event) {
+    flush_pointer_motion(display);
+
     uint32_t button = libinput_event_pointer_get_button(event);
     enum libinput_button_state state = libinput_event_pointer_get_button_state(event);
+    uint64_t time_usec = libinput_event_pointer_get_time_usec(event);
 
     struct Owl_Input input = {
         .keycode = 0,
@@ -194,16 +227,30 @@ static void handle_pointer_button(Owl_Display* display, struct libinput_event_po
         .button = button,
         .pointer_x = (int)display->pointer_x,
         .pointer_y = (int)display->pointer_y,
+        .time_usec = time_usec,
     };
 
-    Owl_Input_Event event_type = state == LIBINPUT_BUTTON_STATE_PRESSED
-        ? OWL_INPUT_BUTTON_PRESS : OWL_INPUT_BUTTON_RELEASE;
+    bool pressed = state == LIBINPUT_BUTTON_STATE_PRESSED;
+    if (pressed) {
+        display->buttons_pressed++;
+    } else if (display->buttons_pressed > 0) {
+        display->buttons_pressed--;
+    }
+
+    if (display->grab_mode != OWL_GRAB_NONE) {
+        if (!pressed && display->buttons_pressed == 0) {
+            owl_display_end_grab(display);
+            flush_pointer_motion(display);
+        }
+        return;
+    }
+
+    Owl_Input_Event event_type = pressed ? OWL_INPUT_BUTTON_PRESS : OWL_INPUT_BUTTON_RELEASE;
 
     owl_invoke_input_callback(display, event_type, &input);
 
-    uint32_t wl_state = state == LIBINPUT_BUTTON_STATE_PRESSED
-        ? WL_POINTER_BUTTON_STATE_PRESSED : WL_POINTER_BUTTON_STATE_RELEASED;
-    owl_seat_send_pointer_button(display, button, wl_state);
+    uint32_t wl_state = pressed ? WL_POINTER_BUTTON_STATE_PRESSED : WL_POINTER_BUTTON_STATE_RELEASED;
+    owl_seat_send_pointer_button(display, time_usec, button, wl_state);
 }
 
 static int handle_libinput_event(int fd, uint32_t mask, void* data) {
@@ -237,6 +284,10 @@ static int handle_libinput_event(int fd, uint32_t mask, void* data) {
         libinput_event_destroy(event);
     }
 
+    if (!display->motion_coalesce_ms) {
+        flush_pointer_motion(display);
+    }
+
     return 0;
 }
 
@@ -316,6 +367,7 @@ void owl_input_init(Owl_Display* display) {
             display->xkb_state = xkb_state_new(display->xkb_keymap);
         }
     }
+    cache_modifier_indices(display);
 
     display->keymap_fd = create_keymap_fd(display);
 
@@ -323,6 +375,7 @@ void owl_input_init(Owl_Display* display) {
     display->libinput_event_source = wl_event_loop_add_fd(
         display->event_loop, libinput_fd,
         WL_EVENT_READABLE, handle_libinput_event, display);
+    display->motion_timer = wl_event_loop_add_timer(display->event_loop, handle_motion_timer, display);
 
     libinput_dispatch(display->libinput);
     struct libinput_event* event;
@@ -342,6 +395,11 @@ void owl_input_init(Owl_Display* display) {
 }
 
 void owl_input_cleanup(Owl_Display* display) {
+    if (display->motion_timer) {
+        wl_event_source_remove(display->motion_timer);
+        display->motion_timer = NULL;
+    }
+
     if (display->libinput_event_source) {
         wl_event_source_remove(display->libinput_event_source);
         display->libinput_event_source = NULL;
@@ -398,7 +456,6 @@ static void keyboard_destroy_handler(struct wl_resource* resource) {
 static void pointer_set_cursor(struct wl_client* client, struct wl_resource* resource,
                                uint32_t serial, struct wl_resource* surface_resource,
                                int32_t hotspot_x, int32_t hotspot_y) {
-    (void)client;
     (void)serial;
 
     input_debug("pointer_set_cursor: surface_resource=%p hotspot=%d,%d\n",
@@ -412,9 +469,19 @@ static void pointer_set_cursor(struct wl_client* client, struct wl_resource* res
 
     Owl_Display* display = pointer->display;
 
+    if (!display->pointer_focus || !display->pointer_focus_client ||
+        display->pointer_focus_client->client != client) {
+        input_debug("  client does not have pointer focus\n");
+        return;
+    }
+
+    display->cursor_client_set = true;
+
     if (!surface_resource) {
         input_debug("  hiding cursor\n");
         display->cursor_surface = NULL;
+        owl_cursor_update(display);
+        owl_display_damage_cursor(display, true);
         return;
     }
 
@@ -430,6 +497,8 @@ static void pointer_set_cursor(struct wl_client* client, struct wl_resource* res
     display->cursor_surface = cursor_surface;
     display->cursor_hotspot_x = hotspot_x;
     display->cursor_hotspot_y = hotspot_y;
+    owl_cursor_update(display);
+    owl_display_damage_cursor(display, true);
 }
 
 static void pointer_release(struct wl_client* client, struct wl_resource* resource) {
@@ -470,7 +539,12 @@ static void seat_get_pointer(struct wl_client* client, struct wl_resource* resou
 
     pointer->display = display;
     wl_resource_set_implementation(pointer->resource, &pointer_interface, pointer, pointer_destroy_handler);
-    wl_list_insert(&display->pointers, &pointer->link);
+    Owl_Client* owner = owl_client_from_wl(client);
+    if (owner) {
+        wl_list_insert(&owner->pointers, &pointer->link);
+    } else {
+        wl_list_init(&pointer->link);
+    }
 }
 
 static void seat_get_keyboard(struct wl_client* client, struct wl_resource* resource, uint32_t id) {
@@ -493,7 +567,12 @@ static void seat_get_keyboard(struct wl_client* client, struct wl_resource* reso
     }
 
     wl_resource_set_implementation(keyboard->resource, &keyboard_interface, keyboard, keyboard_destroy_handler);
-    wl_list_insert(&display->keyboards, &keyboard->link);
+    Owl_Client* owner = owl_client_from_wl(client);
+    if (owner) {
+        wl_list_insert(&owner->keyboards, &keyboard->link);
+    } else {
+        wl_list_init(&keyboard->link);
+    }
     input_debug("  keyboard resource=%p\n", (void*)keyboard->resource);
 
     if (display->keymap_fd >= 0) {
@@ -547,9 +626,6 @@ static void seat_bind(struct wl_client* client, void* data, uint32_t version, ui
 }
 
 void owl_seat_init(Owl_Display* display) {
-    wl_list_init(&display->keyboards);
-    wl_list_init(&display->pointers);
-
     display->seat_global = wl_global_create(display->wayland_display,
         &wl_seat_interface, 7, display, seat_bind);
 
@@ -580,42 +656,29 @@ void owl_seat_set_keyboard_focus(Owl_Display* display, Owl_Surface* surface) {
     uint32_t serial = wl_display_next_serial(display->wayland_display);
     input_debug("  serial=%u\n", serial);
 
-    if (display->keyboard_focus) {
-        struct wl_client* old_client = wl_resource_get_client(display->keyboard_focus->resource);
-        input_debug("  sending leave to old client %p\n", (void*)old_client);
+    Owl_Client* old_client = display->keyboard_focus_client;
+    if (display->keyboard_focus && old_client) {
+        input_debug("  sending leave to old client %p\n", (void*)old_client->client);
         Owl_Keyboard* keyboard;
-        wl_list_for_each(keyboard, &display->keyboards, link) {
-            if (wl_resource_get_client(keyboard->resource) == old_client) {
-                input_debug("    sending leave to keyboard %p\n", (void*)keyboard->resource);
-                wl_keyboard_send_leave(keyboard->resource, serial, display->keyboard_focus->resource);
-            }
+        wl_list_for_each(keyboard, &old_client->keyboards, link) {
+            input_debug("    sending leave to keyboard %p\n", (void*)keyboard->resource);
+            wl_keyboard_send_leave(keyboard->resource, serial, display->keyboard_focus->resource);
         }
     }
 
     display->keyboard_focus = surface;
+    display->keyboard_focus_client = owl_client_from_resource(surface ? surface->resource : NULL);
 
-    if (surface) {
-        struct wl_client* new_client = wl_resource_get_client(surface->resource);
-        input_debug("  sending enter to new client %p\n", (void*)new_client);
+    Owl_Client* new_client = display->keyboard_focus_client;
+    if (surface && new_client) {
+        input_debug("  sending enter to new client %p\n", (void*)new_client->client);
         struct wl_array keys;
         wl_array_init(&keys);
 
-        int keyboard_count = 0;
         Owl_Keyboard* keyboard;
-        wl_list_for_each(keyboard, &display->keyboards, link) {
-            keyboard_count++;
-        }
-        input_debug("  total keyboards: %d\n", keyboard_count);
-
-        wl_list_for_each(keyboard, &display->keyboards, link) {
-            input_debug("    checking keyboard %p client=%p\n",
-                        (void*)keyboard->resource,
-                        (void*)wl_resource_get_client(keyboard->resource));
-            if (wl_resource_get_client(keyboard->resource) == new_client) {
-                input_debug("    sending enter to keyboard %p\n", (void*)keyboard->resource);
-                wl_keyboard_send_enter(keyboard->resource, serial, surface->resource, &keys);
-                input_debug("    enter sent\n");
-            }
+        wl_list_for_each(keyboard, &new_client->keyboards, link) {
+            input_debug("    sending enter to keyboard %p\n", (void*)keyboard->resource);
+            wl_keyboard_send_enter(keyboard->resource, serial, surface->resource, &keys);
         }
 
         wl_array_release(&keys);
@@ -633,55 +696,55 @@ void owl_seat_set_pointer_focus(Owl_Display* display, Owl_Surface* surface, doub
 
     uint32_t serial = wl_display_next_serial(display->wayland_display);
 
-    if (display->pointer_focus) {
-        struct wl_client* old_client = wl_resource_get_client(display->pointer_focus->resource);
+    Owl_Client* old_client = display->pointer_focus_client;
+    if (display->pointer_focus && old_client) {
         Owl_Pointer* pointer;
-        wl_list_for_each(pointer, &display->pointers, link) {
-            if (wl_resource_get_client(pointer->resource) == old_client) {
-                wl_pointer_send_leave(pointer->resource, serial, display->pointer_focus->resource);
-                wl_pointer_send_frame(pointer->resource);
-            }
+        wl_list_for_each(pointer, &old_client->pointers, link) {
+            wl_pointer_send_leave(pointer->resource, serial, display->pointer_focus->resource);
+            wl_pointer_send_frame(pointer->resource);
         }
     }
 
     display->pointer_focus = surface;
-
-    if (surface) {
-        struct wl_client* new_client = wl_resource_get_client(surface->resource);
+    display->pointer_focus_client = owl_client_from_resource(surface ? surface->resource : NULL);
+    display->cursor_client_set = false;
+    display->cursor_surface = NULL;
+    owl_cursor_update(display);
+    owl_display_damage_cursor(display, true);
+
+    Owl_Client* new_client = display->pointer_focus_client;
+    if (surface && new_client) {
         Owl_Pointer* pointer;
-        wl_list_for_each(pointer, &display->pointers, link) {
-            if (wl_resource_get_client(pointer->resource) == new_client) {
-                wl_pointer_send_enter(pointer->resource, serial, surface->resource,
-                                      wl_fixed_from_double(x), wl_fixed_from_double(y));
-                wl_pointer_send_frame(pointer->resource);
-            }
+        wl_list_for_each(pointer, &new_client->pointers, link) {
+            wl_pointer_send_enter(pointer->resource, serial, surface->resource,
+                                  wl_fixed_from_double(x), wl_fixed_from_double(y));
+            wl_pointer_send_frame(pointer->resource);
         }
     }
 }
 
-void owl_seat_send_key(Owl_Display* display, uint32_t key, uint32_t state) {
-    if (!display->keyboard_focus) {
+void owl_seat_send_key(Owl_Display* display, uint64_t time_usec, uint32_t key, uint32_t state) {
+    Owl_Client* client = display->keyboard_focus_client;
+    if (!display->keyboard_focus || !client) {
         return;
     }
 
-    struct wl_client* client = wl_resource_get_client(display->keyboard_focus->resource);
     uint32_t serial = wl_display_next_serial(display->wayland_display);
-    uint32_t time = get_time_ms();
+    uint32_t time = (uint32_t)(time_usec / 1000);
 
     Owl_Keyboard* keyboard;
-    wl_list_for_each(keyboard, &display->keyboards, link) {
-        if (wl_resource_get_client(keyboard->resource) == client) {
-            wl_keyboard_send_key(keyboard->resource, serial, time, key, state);
-        }
+    wl_list_for_each(keyboard, &client->keyboards, link) {
+        owl_input_timestamps_send(client, keyboard->resource, time_usec);
+        wl_keyboard_send_key(keyboard->resource, serial, time, key, state);
     }
 }
 
 void owl_seat_send_modifiers(Owl_Display* display) {
-    if (!display->keyboard_focus || !display->xkb_state) {
+    Owl_Client* client = display->keyboard_focus_client;
+    if (!display->keyboard_focus || !client || !display->xkb_state) {
         return;
     }
 
-    struct wl_client* client = wl_resource_get_client(display->keyboard_focus->resource);
     uint32_t serial = wl_display_next_serial(display->wayland_display);
     uint32_t depressed = xkb_state_serialize_mods(display->xkb_state, XKB_STATE_MODS_DEPRESSED);
     uint32_t latched = xkb_state_serialize_mods(display->xkb_state, XKB_STATE_MODS_LATCHED);
@@ -689,49 +752,63 @@ void owl_seat_send_modifiers(Owl_Display* display) {
     uint32_t group = xkb_state_serialize_layout(display->xkb_state, XKB_STATE_LAYOUT_EFFECTIVE);
 
     Owl_Keyboard* keyboard;
-    wl_list_for_each(keyboard, &display->keyboards, link) {
-        if (wl_resource_get_client(keyboard->resource) == client) {
-            wl_keyboard_send_modifiers(keyboard->resource, serial, depressed, latched, locked, group);
-        }
+    wl_list_for_each(keyboard, &client->keyboards, link) {
+        wl_keyboard_send_modifiers(keyboard->resource, serial, depressed, latched, locked, group);
     }
 }
 
-void owl_seat_send_pointer_motion(Owl_Display* display, double x, double y) {
-    if (!display->pointer_focus) {
+void owl_seat_send_pointer_motion(Owl_Display* display, uint64_t time_usec, double x, double y) {
+    Owl_Client* client = display->pointer_focus_client;
+    if (!display->pointer_focus || !client) {
         return;
     }
 
-    struct wl_client* client = wl_resource_get_client(display->pointer_focus->resource);
-    uint32_t time = get_time_ms();
+    uint32_t time = (uint32_t)(time_usec / 1000);
 
     Owl_Pointer* pointer;
-    wl_list_for_each(pointer, &display->pointers, link) {
-        if (wl_resource_get_client(pointer->resource) == client) {
-            wl_pointer_send_motion(pointer->resource, time,
-                                   wl_fixed_from_double(x), wl_fixed_from_double(y));
-            wl_pointer_send_frame(pointer->resource);
-        }
+    wl_list_for_each(pointer, &client->pointers, link) {
+        owl_input_timestamps_send(client, pointer->resource, time_usec);
+        wl_pointer_send_motion(pointer->resource, time,
+                               wl_fixed_from_double(x), wl_fixed_from_double(y));
+    }
+    if (display->motion_dx || display->motion_dy || display->motion_dx_unaccel || display->motion_dy_unaccel) {
+        owl_relative_pointer_send_motion(display, time_usec, display->motion_dx, display->motion_dy,
+                                         display->motion_dx_unaccel, display->motion_dy_unaccel);
+    }
+    wl_list_for_each(pointer, &client->pointers, link) {
+        wl_pointer_send_frame(pointer->resource);
     }
 }
 
-void owl_seat_send_pointer_button(Owl_Display* display, uint32_t button, uint32_t state) {
-    if (!display->pointer_focus) {
+void owl_seat_send_pointer_button(Owl_Display* display, uint64_t time_usec, uint32_t button, uint32_t state) {
+    Owl_Client* client = display->pointer_focus_client;
+    if (!display->pointer_focus || !client) {
         return;
     }
 
-    struct wl_client* client = wl_resource_get_client(display->pointer_focus->resource);
     uint32_t serial = wl_display_next_serial(display->wayland_display);
-    uint32_t time = get_time_ms();
+    uint32_t time = (uint32_t)(time_usec / 1000);
+    if (state == WL_POINTER_BUTTON_STATE_PRESSED) {
+        display->button_serial = serial;
+    }
 
     Owl_Pointer* pointer;
-    wl_list_for_each(pointer, &display->pointers, link) {
-        if (wl_resource_get_client(pointer->resource) == client) {
-            wl_pointer_send_button(pointer->resource, serial, time, button, state);
-            wl_pointer_send_frame(pointer->resource);
-        }
+    wl_list_for_each(pointer, &client->pointers, link) {
+        owl_input_timestamps_send(client, pointer->resource, time_usec);
+        wl_pointer_send_button(pointer->resource, serial, time, button, state);
+        wl_pointer_send_frame(pointer->resource);
     }
 }
 
+void owl_display_set_motion_coalesce(Owl_Display* display, uint32_t window_ms) {
+    if (!display) {
+        return;
+    }
+
+    display->motion_coalesce_ms = window_ms;
+    flush_pointer_motion(display);
+}
+
 uint32_t owl_input_get_keycode(Owl_Input* input) {
     return input ? input->keycode : 0;
 }
@@ -755,3 +832,7 @@ int owl_input_get_pointer_x(Owl_Input* input) {
 int owl_input_get_pointer_y(Owl_Input* input) {
     return input ? input->pointer_y : 0;
 }
+
+uint64_t owl_input_get_time_usec(Owl_Input* input) {
+    return input ? input->time_usec : 0;
+}
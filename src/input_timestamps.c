@@ -0,0 +1,150 @@
+#define _GNU_SOURCE
+#include "internal.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <wayland-server-core.h>
+#include <wayland-server-protocol.h>
+#include "input-timestamps-unstable-v1-protocol.h"
+#include "input-timestamps-unstable-v1-protocol.c"
+
+typedef struct Owl_Input_Timestamps {
+    struct wl_resource* resource;
+    struct wl_resource* input_resource;
+    struct wl_listener input_destroy;
+    struct wl_list link;
+} Owl_Input_Timestamps;
+
+static void timestamps_destroy(struct wl_client* client, struct wl_resource* resource) {
+    (void)client;
+    wl_resource_destroy(resource);
+}
+
+static const struct zwp_input_timestamps_v1_interface timestamps_interface = {
+    .destroy = timestamps_destroy,
+};
+
+static void timestamps_input_destroyed(struct wl_listener* listener, void* data) {
+    (void)data;
+    Owl_Input_Timestamps* timestamps = wl_container_of(listener, timestamps, input_destroy);
+    timestamps->input_resource = NULL;
+    wl_list_remove(&timestamps->input_destroy.link);
+    wl_list_init(&timestamps->input_destroy.link);
+}
+
+static void timestamps_destroy_handler(struct wl_resource* resource) {
+    Owl_Input_Timestamps* timestamps = wl_resource_get_user_data(resource);
+    if (timestamps) {
+        wl_list_remove(&timestamps->input_destroy.link);
+        wl_list_remove(&timestamps->link);
+        free(timestamps);
+    }
+}
+
+static void create_timestamps(struct wl_client* client, struct wl_resource* resource,
+                              uint32_t id, struct wl_resource* input_resource) {
+    Owl_Client* owner = owl_client_from_wl(client);
+
+    Owl_Input_Timestamps* timestamps = calloc(1, sizeof(Owl_Input_Timestamps));
+    if (!timestamps) {
+        wl_resource_post_no_memory(resource);
+        return;
+    }
+
+    timestamps->resource = wl_resource_create(client, &zwp_input_timestamps_v1_interface,
+                                              wl_resource_get_version(resource), id);
+    if (!timestamps->resource) {
+        free(timestamps);
+        wl_resource_post_no_memory(resource);
+        return;
+    }
+
+    wl_resource_set_implementation(timestamps->resource, &timestamps_interface, timestamps,
+                                   timestamps_destroy_handler);
+
+    timestamps->input_destroy.notify = timestamps_input_destroyed;
+    wl_list_init(&timestamps->input_destroy.link);
+    if (input_resource) {
+        timestamps->input_resource = input_resource;
+        wl_resource_add_destroy_listener(input_resource, &timestamps->input_destroy);
+    }
+    if (owner) {
+        wl_list_insert(&owner->input_timestamps, &timestamps->link);
+    } else {
+        wl_list_init(&timestamps->link);
+    }
+}
+
+static void manager_destroy(struct wl_client* client, struct wl_resource* resource) {
+    (void)client;
+    wl_resource_destroy(resource);
+}
+
+static void manager_get_keyboard_timestamps(struct wl_client* client, struct wl_resource* resource,
+                                            uint32_t id, struct wl_resource* keyboard) {
+    create_timestamps(client, resource, id, keyboard);
+}
+
+static void manager_get_pointer_timestamps(struct wl_client* client, struct wl_resource* resource,
+                                           uint32_t id, struct wl_resource* pointer) {
+    create_timestamps(client, resource, id, pointer);
+}
+
+static void manager_get_touch_timestamps(struct wl_client* client, struct wl_resource* resource,
+                                         uint32_t id, struct wl_resource* touch) {
+    (void)touch;
+    create_timestamps(client, resource, id, NULL);
+}
+
+static const struct zwp_input_timestamps_manager_v1_interface manager_interface = {
+    .destroy = manager_destroy,
+    .get_keyboard_timestamps = manager_get_keyboard_timestamps,
+    .get_pointer_timestamps = manager_get_pointer_timestamps,
+    .get_touch_timestamps = manager_get_touch_timestamps,
+};
+
+static void manager_bind(struct wl_client* client, void* data, uint32_t version, uint32_t id) {
+    Owl_Display* display = data;
+
+    struct wl_resource* resource = wl_resource_create(client, &zwp_input_timestamps_manager_v1_interface,
+                                                      version < 1 ? version : 1, id);
+    if (!resource) {
+        wl_client_post_no_memory(client);
+        return;
+    }
+
+    wl_resource_set_implementation(resource, &manager_interface, display, NULL);
+}
+
+void owl_input_timestamps_init(Owl_Display* display) {
+    display->input_timestamps_manager_global = wl_global_create(display->wayland_display,
+        &zwp_input_timestamps_manager_v1_interface, 1, display, manager_bind);
+
+    if (!display->input_timestamps_manager_global) {
+        fprintf(stderr, "owl: failed to create zwp_input_timestamps_manager_v1 global\n");
+    }
+}
+
+void owl_input_timestamps_cleanup(Owl_Display* display) {
+    if (display->input_timestamps_manager_global) {
+        wl_global_destroy(display->input_timestamps_manager_global);
+        display->input_timestamps_manager_global = NULL;
+    }
+}
+
+void owl_input_timestamps_send(Owl_Client* client, struct wl_resource* input_resource,
+                               uint64_t time_usec) {
+    if (wl_list_empty(&client->input_timestamps)) {
+        return;
+    }
+
+    uint64_t seconds = time_usec / 1000000;
+    uint32_t nanoseconds = (uint32_t)(time_usec % 1000000) * 1000;
+
+    Owl_Input_Timestamps* timestamps;
+    wl_list_for_each(timestamps, &client->input_timestamps, link) {
+        if (timestamps->input_resource == input_resource) {
+            zwp_input_timestamps_v1_send_timestamp(timestamps->resource,
+                (uint32_t)(seconds >> 32), (uint32_t)seconds, nanoseconds);
+        }
+    }
+}
@@ -2,15 +2,52 @@
 #define OWL_INTERNAL_H
 
 #include <owl/owl.h>
+#include "convert.h"
 #include <wayland-server-core.h>
 #include <xkbcommon/xkbcommon.h>
 #include <xf86drmMode.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdatomic.h>
+
+#define OWL_MAX_PLANES 3
+#define OWL_MAX_DMABUF_PLANES 4
+
+#define OWL_GRID_CELL_SIZE 256
+#define OWL_GRID_BUCKETS 64
+#define OWL_MAX_DAMAGE_RECTS 8
+#define OWL_MAX_BINDING_MODES 16
+#define OWL_MAX_KEYCODES 768
+#define OWL_MAX_ARMED_RELEASES 16
+#define OWL_DAMAGE_HISTORY 4
+#define OWL_WINDOW_EVENT_COUNT (OWL_WINDOW_EVENT_RESPONDING + 1)
+#define OWL_RENDER_STAGE_COUNT (OWL_RENDER_STAGE_AFTER_WINDOWS + 1)
+
+#define OWL_STACK_MAPPED (1 << 0)
+#define OWL_STACK_CONTENT (1 << 1)
+#define OWL_STACK_OPAQUE (1 << 2)
+#define OWL_STACK_OCCLUDED (1 << 3)
+#define OWL_STACK_HIDDEN (1 << 4)
+
+typedef struct Owl_Rect {
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    int32_t height;
+} Owl_Rect;
 
-#define OWL_MAX_OUTPUTS 8
-#define OWL_MAX_WINDOWS 256
-#define OWL_MAX_CALLBACKS 16
+typedef struct Owl_Damage {
+    Owl_Rect rects[OWL_MAX_DAMAGE_RECTS];
+    int count;
+    bool full;
+} Owl_Damage;
+
+typedef struct Owl_Region {
+    Owl_Rect* rects;
+    int count;
+    int capacity;
+    Owl_Rect extents;
+} Owl_Region;
 
 struct Owl_Output {
     struct Owl_Display* display;
@@ -28,12 +65,71 @@ struct Owl_Output {
     struct gbm_bo* current_bo;
     struct gbm_bo* next_bo;
     bool page_flip_pending;
+    bool frame_scheduled;
+    struct wl_event_source* frame_idle;
+    uint32_t workspace;
+    Owl_Damage damage;
+    Owl_Damage damage_history[OWL_DAMAGE_HISTORY];
+    int damage_history_index;
+    struct wl_array draw_commands[OWL_RENDER_STAGE_COUNT];
     struct wl_global* wl_output_global;
 };
 
+typedef enum {
+    OWL_SHADER_RGBA,
+    OWL_SHADER_RGBX,
+    OWL_SHADER_BGRA,
+    OWL_SHADER_BGRX,
+    OWL_SHADER_NV12,
+    OWL_SHADER_YUV420,
+    OWL_SHADER_YUYV,
+    OWL_SHADER_COUNT,
+} Owl_Shader_Kind;
+
+typedef struct Owl_Format_Plane {
+    uint32_t gl_format;
+    uint32_t gl_type;
+    uint32_t drm_format;
+    int32_t bytes_per_texel;
+    int32_t pixels_per_texel;
+    int32_t hsub;
+    int32_t vsub;
+} Owl_Format_Plane;
+
+typedef enum {
+    OWL_GL_CAP_BGRA8888 = 1 << 0,
+    OWL_GL_CAP_TYPE_2_10_10_10_REV = 1 << 1,
+    OWL_GL_CAP_HALF_FLOAT = 1 << 2,
+    OWL_GL_CAP_HALF_FLOAT_LINEAR = 1 << 3,
+    OWL_GL_CAP_NPOT_MIPMAP = 1 << 4,
+} Owl_Gl_Cap;
+
+typedef struct Owl_Format_Upload {
+    uint32_t gl_format;
+    uint32_t gl_type;
+    Owl_Shader_Kind shader;
+    uint32_t requires;
+    Owl_Convert_Kind convert;
+} Owl_Format_Upload;
+
+typedef struct Owl_Format_Info {
+    uint32_t shm_format;
+    uint32_t drm_format;
+    Owl_Shader_Kind shader;
+    uint32_t requires;
+    Owl_Convert_Kind convert;
+    Owl_Format_Upload fallback;
+    bool has_fallback;
+    bool has_alpha;
+    bool is_yuv;
+    int plane_count;
+    Owl_Format_Plane planes[OWL_MAX_PLANES];
+} Owl_Format_Info;
+
 typedef struct Owl_Shm_Pool {
     struct Owl_Display* display;
     struct wl_resource* resource;
+    struct wl_client* client;
     int fd;
     void* data;
     int32_t size;
@@ -48,20 +144,41 @@ typedef struct Owl_Shm_Buffer {
     int32_t height;
     int32_t stride;
     uint32_t format;
+    const Owl_Format_Info* format_info;
     bool busy;
 } Owl_Shm_Buffer;
 
+typedef struct Owl_Dmabuf_Buffer {
+    struct Owl_Display* display;
+    struct wl_resource* resource;
+    int32_t width;
+    int32_t height;
+    uint32_t format;
+    uint32_t flags;
+    const Owl_Format_Info* format_info;
+    int plane_count;
+    int fds[OWL_MAX_DMABUF_PLANES];
+    uint32_t offsets[OWL_MAX_DMABUF_PLANES];
+    uint32_t strides[OWL_MAX_DMABUF_PLANES];
+    uint64_t modifier;
+    void* images[OWL_MAX_PLANES];
+} Owl_Dmabuf_Buffer;
+
 typedef struct Owl_Surface_State {
     Owl_Shm_Buffer* buffer;
+    struct wl_listener buffer_destroy;
+    Owl_Dmabuf_Buffer* dmabuf;
+    struct wl_listener dmabuf_destroy;
     int32_t buffer_x;
     int32_t buffer_y;
     bool buffer_attached;
     struct wl_list frame_callbacks;
-    int32_t damage_x;
-    int32_t damage_y;
-    int32_t damage_width;
-    int32_t damage_height;
-    bool has_damage;
+    Owl_Region damage;
+    Owl_Region opaque_region;
+    Owl_Region input_region;
+    bool input_infinite;
+    bool opaque_region_changed;
+    bool input_region_changed;
 } Owl_Surface_State;
 
 typedef struct Owl_Surface {
@@ -70,12 +187,47 @@ typedef struct Owl_Surface {
     Owl_Surface_State pending;
     Owl_Surface_State current;
     uint32_t texture_id;
+    uint32_t chroma_texture_ids[OWL_MAX_PLANES - 1];
     int32_t texture_width;
     int32_t texture_height;
+    uint32_t texture_format;
+    Owl_Shader_Kind shader;
+    Owl_Yuv_Encoding yuv_encoding;
+    Owl_Yuv_Range yuv_range;
+    bool chroma_from_dmabuf;
     bool has_content;
+    bool opaque;
+    bool buffer_released;
+    bool hidden;
+    bool stale;
+    bool evicted;
+    bool layout_held;
+    uint64_t texture_bytes;
+    uint64_t last_visible;
     struct wl_list link;
 } Owl_Surface;
 
+typedef struct Owl_Cursor_Image {
+    int32_t width;
+    int32_t height;
+    int32_t hotspot_x;
+    int32_t hotspot_y;
+    uint32_t delay;
+    uint32_t nominal_size;
+    uint32_t texture_id;
+    Owl_Shader_Kind shader;
+    struct gbm_bo* bo;
+} Owl_Cursor_Image;
+
+typedef struct Owl_Cursor {
+    char* name;
+    Owl_Cursor_Image* images;
+    int image_count;
+    int frame_first;
+    int frame_count;
+    struct wl_list link;
+} Owl_Cursor;
+
 typedef struct Owl_Frame_Callback {
     struct wl_resource* resource;
     struct wl_list link;
@@ -94,12 +246,61 @@ struct Owl_Window {
     char* app_id;
     bool fullscreen;
     bool focused;
+    bool resizing;
     bool mapped;
+    bool hidden;
+    Owl_Output* output;
+    uint32_t workspace;
     uint32_t pending_serial;
     bool pending_configure;
+    bool configure_scheduled;
+    bool configure_sent;
+    int32_t sent_width;
+    int32_t sent_height;
+    uint32_t sent_states;
+    struct wl_list configure_link;
+    bool layout_pending;
+    int stack_index;
+    uint32_t thumbnail_texture;
+    int32_t thumbnail_width;
+    int32_t thumbnail_height;
+    uint32_t thumbnail_time;
+    bool thumbnail_dirty;
+    uint32_t queued_events[OWL_WINDOW_EVENT_COUNT];
+    bool grid_indexed;
+    int32_t grid_x0;
+    int32_t grid_y0;
+    int32_t grid_x1;
+    int32_t grid_y1;
     struct wl_list link;
 };
 
+typedef enum {
+    OWL_GRAB_NONE,
+    OWL_GRAB_MOVE,
+    OWL_GRAB_RESIZE,
+} Owl_Grab_Mode;
+
+typedef struct Owl_Window_Stack {
+    Owl_Window** windows;
+    Owl_Surface** surfaces;
+    int32_t* x;
+    int32_t* y;
+    int32_t* width;
+    int32_t* height;
+    int32_t* content_width;
+    int32_t* content_height;
+    uint8_t* flags;
+    int count;
+    int capacity;
+} Owl_Window_Stack;
+
+typedef struct Owl_Task {
+    Owl_Task_Callback callback;
+    void* data;
+    struct Owl_Task* _Atomic next;
+} Owl_Task;
+
 struct Owl_Input {
     uint32_t keycode;
     uint32_t keysym;
@@ -107,13 +308,77 @@ struct Owl_Input {
     uint32_t button;
     int pointer_x;
     int pointer_y;
+    uint64_t time_usec;
 };
 
+typedef struct Owl_Binding {
+    uint32_t mode;
+    uint32_t modifiers;
+    uint32_t keysym;
+    uint32_t flags;
+    Owl_Binding_Callback callback;
+    void* data;
+    uint8_t state;
+} Owl_Binding;
+
+typedef struct Owl_Armed_Release {
+    uint32_t keycode;
+    Owl_Binding_Callback callback;
+    void* data;
+} Owl_Armed_Release;
+
+typedef struct Owl_Client {
+    struct Owl_Display* display;
+    struct wl_client* client;
+    struct wl_listener destroy;
+    struct wl_list keyboards;
+    struct wl_list pointers;
+    struct wl_list relative_pointers;
+    struct wl_list input_timestamps;
+    struct wl_resource* wm_base;
+    uint32_t ping_serial;
+    uint64_t ping_sent_usec;
+    bool ping_pending;
+    bool not_responding;
+    uint32_t latency_usec;
+    uint64_t requests;
+    uint64_t bytes;
+    uint32_t iteration_requests;
+    uint32_t flood_strikes;
+    uint32_t deferrals;
+    uint32_t surface_count;
+    uint64_t shm_bytes;
+    uint64_t texture_bytes;
+    uint32_t frame_callbacks;
+    bool over_budget;
+    bool disconnecting;
+    struct wl_list link;
+} Owl_Client;
+
 typedef struct {
     Owl_Window_Callback callback;
     void* data;
 } Window_Callback_Entry;
 
+typedef struct {
+    Owl_Window_Event type;
+    Owl_Window* window;
+    uint32_t sequence;
+} Queued_Window_Event;
+
+typedef struct {
+    Owl_Window* window;
+    int x;
+    int y;
+    int width;
+    int height;
+    uint32_t serial;
+    bool moved;
+    bool resized;
+    bool acked;
+    bool ready;
+} Owl_Layout_Entry;
+
 typedef struct {
     Owl_Input_Callback callback;
     void* data;
@@ -124,9 +389,42 @@ typedef struct {
     void* data;
 } Output_Callback_Entry;
 
+typedef struct {
+    Owl_Render_Hook hook;
+    void* data;
+} Render_Hook_Entry;
+
+typedef enum {
+    OWL_DRAW_RECT,
+    OWL_DRAW_TEXTURE,
+} Owl_Draw_Kind;
+
+typedef struct {
+    Owl_Draw_Kind kind;
+    Owl_Rect rect;
+    float color[4];
+    uint32_t texture_id;
+    Owl_Shader_Kind shader;
+} Owl_Draw_Command;
+
+struct Owl_Texture {
+    struct Owl_Display* display;
+    uint32_t id;
+    Owl_Shader_Kind shader;
+    int32_t width;
+    int32_t height;
+};
+
 struct Owl_Display {
     struct wl_display* wayland_display;
     struct wl_event_loop* event_loop;
+    Owl_Task task_stub;
+    Owl_Task* _Atomic task_head;
+    Owl_Task* task_tail;
+    atomic_bool task_signaled;
+    int task_fd;
+    struct wl_event_source* task_source;
+    struct wl_list event_sources;
     const char* socket_name;
     bool running;
 
@@ -135,6 +433,15 @@ struct Owl_Display {
     void* egl_display;
     void* egl_context;
     void* egl_config;
+    bool egl_buffer_age;
+    uint32_t gl_caps;
+    uint32_t thumbnail_fbo;
+    uint32_t thumbnail_interval_ms;
+    struct wl_event_source* thumbnail_timer;
+    bool thumbnail_armed;
+    uint64_t thumbnail_bytes;
+    uint8_t* convert_scratch;
+    size_t convert_scratch_size;
 
     struct libinput* libinput;
     struct udev* udev;
@@ -142,12 +449,31 @@ struct Owl_Display {
     struct xkb_keymap* xkb_keymap;
     struct xkb_state* xkb_state;
     uint32_t modifier_state;
-
-    struct Owl_Output* outputs[OWL_MAX_OUTPUTS];
+    uint32_t modifier_indices[4];
+
+    Owl_Binding* bindings;
+    uint32_t binding_capacity;
+    uint32_t binding_count;
+    uint32_t binding_tombstones;
+    char* binding_modes[OWL_MAX_BINDING_MODES];
+    int binding_mode_count;
+    uint32_t binding_mode;
+    bool binding_mode_oneshot;
+    uint64_t consumed_keys[OWL_MAX_KEYCODES / 64];
+    Owl_Armed_Release armed_releases[OWL_MAX_ARMED_RELEASES];
+
+    struct Owl_Output** outputs;
     int output_count;
+    int output_capacity;
 
     struct wl_list windows;
     int window_count;
+    Owl_Window** window_snapshot;
+    int window_snapshot_count;
+    int window_snapshot_capacity;
+    bool window_snapshot_dirty;
+    Owl_Window_Stack stack;
+    struct wl_array window_grid[OWL_GRID_BUCKETS];
 
     struct wl_list surfaces;
     int surface_count;
@@ -155,37 +481,135 @@ struct Owl_Display {
     struct wl_global* shm_global;
     struct wl_global* subcompositor_global;
     struct wl_global* data_device_manager_global;
-
-    Window_Callback_Entry window_callbacks[12][OWL_MAX_CALLBACKS];
-    int window_callback_count[12];
-
-    Input_Callback_Entry input_callbacks[5][OWL_MAX_CALLBACKS];
-    int input_callback_count[5];
-
-    Output_Callback_Entry output_callbacks[3][OWL_MAX_CALLBACKS];
-    int output_callback_count[3];
+    struct wl_global* linux_dmabuf_global;
+    struct wl_global* relative_pointer_manager_global;
+    struct wl_global* input_timestamps_manager_global;
+
+    struct wl_array window_callbacks[OWL_WINDOW_EVENT_COUNT];
+    Owl_Window_Batch_Callback window_batch_callback;
+    void* window_batch_data;
+    Queued_Window_Event* window_events;
+    uint32_t window_event_head;
+    uint32_t window_event_count;
+    uint32_t window_event_capacity;
+    struct wl_array window_event_batch;
+    bool window_events_delivering;
+    struct wl_list configure_queue;
+    struct wl_array layout_entries;
+    bool layout_recording;
+    bool layout_in_flight;
+    struct wl_event_source* layout_timer;
+    struct wl_event_source* ping_timer;
+    uint32_t ping_interval_ms;
+    uint32_t ping_timeout_ms;
+    uint32_t latency_histogram[OWL_LATENCY_BUCKETS];
+    struct wl_array input_callbacks[5];
+    struct wl_array output_callbacks[3];
+    struct wl_array render_hooks[OWL_RENDER_STAGE_COUNT];
+    Owl_Output* recording_output;
+    int recording_stage;
+    struct wl_array solid_vertices;
 
     struct wl_event_source* drm_event_source;
     struct wl_event_source* libinput_event_source;
 
     struct wl_global* seat_global;
-    struct wl_list keyboards;
-    struct wl_list pointers;
+    struct wl_listener client_created;
+    struct wl_list clients;
     Owl_Surface* keyboard_focus;
     Owl_Surface* pointer_focus;
+    Owl_Client* keyboard_focus_client;
+    Owl_Client* pointer_focus_client;
+    struct wl_protocol_logger* protocol_logger;
+    Owl_Client_Quota client_quota;
+    uint64_t texture_bytes;
+    uint64_t texture_budget;
+    uint64_t texture_evictions;
+    uint64_t texture_restores;
+    uint64_t visibility_epoch;
+    struct wl_event_source* hidden_frame_timer;
+    bool hidden_frame_armed;
     double pointer_x;
     double pointer_y;
+    bool motion_pending;
+    uint64_t motion_time_usec;
+    double motion_dx;
+    double motion_dy;
+    double motion_dx_unaccel;
+    double motion_dy_unaccel;
+    uint32_t motion_coalesce_ms;
+    struct wl_event_source* motion_timer;
+    int buttons_pressed;
+    uint32_t button_serial;
+    Owl_Grab_Mode grab_mode;
+    Owl_Window* grab_window;
+    uint32_t grab_edges;
+    double grab_pointer_x;
+    double grab_pointer_y;
+    int grab_x;
+    int grab_y;
+    int grab_width;
+    int grab_height;
+    int grab_target_width;
+    int grab_target_height;
+    bool grab_resize_queued;
+    bool grab_request_denied;
     int keymap_fd;
     uint32_t keymap_size;
 
     Owl_Surface* cursor_surface;
     int32_t cursor_hotspot_x;
     int32_t cursor_hotspot_y;
+    bool cursor_client_set;
+    Owl_Rect cursor_rect;
+
+    struct wl_list cursors;
+    Owl_Cursor* cursor;
+    int cursor_frame;
+    char* cursor_theme;
+    int cursor_size;
+    struct wl_event_source* cursor_timer;
+    bool hw_cursor_supported;
+    bool hw_cursor_visible;
+    struct gbm_bo* hw_cursor_bo;
+    uint32_t hw_cursor_width;
+    uint32_t hw_cursor_height;
 };
 
+bool owl_has_extension(const char* extensions, const char* name);
+
 void owl_output_init(Owl_Display* display);
 void owl_output_cleanup(Owl_Display* display);
 void owl_output_render_frame(Owl_Output* output);
+void owl_output_schedule_frame(Owl_Output* output);
+void owl_output_damage(Owl_Output* output, int32_t x, int32_t y, int32_t width, int32_t height);
+void owl_output_damage_region(Owl_Output* output, const Owl_Region* region, int32_t dx, int32_t dy);
+void owl_display_schedule_frame(Owl_Display* display);
+void owl_display_damage_cursor(Owl_Display* display, bool force);
+
+void owl_spatial_init(Owl_Display* display);
+void owl_spatial_cleanup(Owl_Display* display);
+void owl_spatial_update_window(Owl_Display* display, Owl_Window* window);
+void owl_spatial_remove_window(Owl_Display* display, Owl_Window* window);
+Owl_Window* owl_spatial_window_at(Owl_Display* display, int32_t x, int32_t y);
+
+void owl_damage_clear(Owl_Damage* damage);
+void owl_damage_add(Owl_Damage* damage, int32_t x, int32_t y, int32_t width, int32_t height);
+void owl_damage_add_damage(Owl_Damage* damage, const Owl_Damage* other);
+
+void owl_region_init(Owl_Region* region);
+void owl_region_fini(Owl_Region* region);
+void owl_region_clear(Owl_Region* region);
+bool owl_region_copy(Owl_Region* dst, const Owl_Region* src);
+void owl_region_swap(Owl_Region* a, Owl_Region* b);
+bool owl_region_is_empty(const Owl_Region* region);
+void owl_region_add_rect(Owl_Region* region, int32_t x, int32_t y, int32_t width, int32_t height);
+void owl_region_subtract_rect(Owl_Region* region, int32_t x, int32_t y, int32_t width, int32_t height);
+bool owl_region_contains_point(const Owl_Region* region, int32_t x, int32_t y);
+bool owl_region_contains_rect(const Owl_Region* region, int32_t x, int32_t y, int32_t width, int32_t height);
+
+bool owl_keybind_handle(Owl_Display* display, uint32_t keycode, bool pressed, Owl_Input* input);
+void owl_keybind_cleanup(Owl_Display* display);
 
 void owl_input_init(Owl_Display* display);
 void owl_input_cleanup(Owl_Display* display);
@@ -195,31 +619,129 @@ void owl_render_init(Owl_Display* display);
 void owl_render_cleanup(Owl_Display* display);
 void owl_render_frame(Owl_Display* display, Owl_Output* output);
 
+void owl_callbacks_cleanup(Owl_Display* display);
 void owl_invoke_window_callback(Owl_Display* display, Owl_Window_Event type, Owl_Window* window);
+void owl_flush_window_events(Owl_Display* display);
+void owl_drop_window_events(Owl_Display* display, Owl_Window* window);
 void owl_invoke_input_callback(Owl_Display* display, Owl_Input_Event type, Owl_Input* input);
 void owl_invoke_output_callback(Owl_Display* display, Owl_Output_Event type, Owl_Output* output);
+void owl_invoke_render_hooks(Owl_Display* display, Owl_Output* output);
 
 void owl_surface_init(Owl_Display* display);
 void owl_surface_cleanup(Owl_Display* display);
 Owl_Surface* owl_surface_from_resource(struct wl_resource* resource);
 void owl_surface_send_frame_done(Owl_Display* display, uint32_t time);
+void owl_surface_send_hidden_frame_done(Owl_Display* display, uint32_t time);
+void owl_surface_release_layout_hold(Owl_Window* window);
 
 void owl_xdg_shell_init(Owl_Display* display);
 void owl_xdg_shell_cleanup(Owl_Display* display);
-void owl_xdg_toplevel_send_configure(Owl_Window* window, int width, int height);
+void owl_xdg_toplevel_schedule_configure(Owl_Window* window, int width, int height);
+void owl_xdg_flush_configures(Owl_Display* display);
+
+void owl_ping_init(Owl_Display* display);
+void owl_ping_cleanup(Owl_Display* display);
+void owl_ping_handle_pong(Owl_Client* client, uint32_t serial);
+void owl_ping_client(Owl_Client* client);
+
+void owl_grab_motion(Owl_Display* display);
+void owl_grab_configure_acked(Owl_Window* window);
+void owl_grab_window_destroyed(Owl_Window* window);
+
+void owl_thumbnail_init(Owl_Display* display);
+void owl_thumbnail_cleanup(Owl_Display* display);
+bool owl_thumbnail_refresh(Owl_Window* window, bool* regenerated);
+void owl_thumbnail_mark_dirty(Owl_Window* window);
+void owl_thumbnail_window_destroyed(Owl_Window* window);
+
+void owl_workspace_init(Owl_Display* display);
+void owl_workspace_cleanup(Owl_Display* display);
+void owl_workspace_place_window(Owl_Window* window);
+void owl_workspace_update_window(Owl_Window* window);
+void owl_workspace_surface_committed(Owl_Surface* surface);
+
+void owl_layout_init(Owl_Display* display);
+void owl_layout_cleanup(Owl_Display* display);
+bool owl_layout_record_move(Owl_Window* window, int x, int y);
+bool owl_layout_record_resize(Owl_Window* window, int width, int height);
+void owl_layout_configure_acked(Owl_Window* window, uint32_t serial);
+bool owl_layout_holds_buffer(Owl_Window* window);
+void owl_layout_surface_committed(Owl_Window* window);
+void owl_layout_window_destroyed(Owl_Window* window);
 void owl_xdg_toplevel_send_close(Owl_Window* window);
 void owl_window_map(Owl_Window* window);
+void owl_windows_changed(Owl_Display* display);
+
+bool owl_stack_insert(Owl_Display* display, Owl_Window* window);
+void owl_stack_remove(Owl_Display* display, Owl_Window* window);
+void owl_stack_sync(Owl_Window* window);
+void owl_stack_cleanup(Owl_Display* display);
+
+void owl_task_init(Owl_Display* display);
+void owl_task_cleanup(Owl_Display* display);
+
+void owl_event_source_init(Owl_Display* display);
+void owl_event_source_cleanup(Owl_Display* display);
+
+void owl_client_init(Owl_Display* display);
+void owl_client_cleanup(Owl_Display* display);
+Owl_Client* owl_client_from_wl(struct wl_client* wl_client);
+Owl_Client* owl_client_from_resource(struct wl_resource* resource);
+void owl_client_disconnect(Owl_Client* client, const char* reason);
+void owl_clients_begin_iteration(Owl_Display* display);
+bool owl_client_throttled(Owl_Client* client);
+bool owl_client_quota_exceeded(Owl_Client* client, uint64_t value, uint64_t limit, const char* reason);
+
+void owl_relative_pointer_init(Owl_Display* display);
+void owl_relative_pointer_cleanup(Owl_Display* display);
+void owl_relative_pointer_send_motion(Owl_Display* display, uint64_t time_usec,
+                                      double dx, double dy, double dx_unaccel, double dy_unaccel);
+
+void owl_input_timestamps_init(Owl_Display* display);
+void owl_input_timestamps_cleanup(Owl_Display* display);
+void owl_input_timestamps_send(Owl_Client* client, struct wl_resource* input_resource,
+                               uint64_t time_usec);
 
 void owl_seat_init(Owl_Display* display);
 void owl_seat_cleanup(Owl_Display* display);
 void owl_seat_set_keyboard_focus(Owl_Display* display, Owl_Surface* surface);
 void owl_seat_set_pointer_focus(Owl_Display* display, Owl_Surface* surface, double x, double y);
-void owl_seat_send_key(Owl_Display* display, uint32_t key, uint32_t state);
+void owl_seat_send_key(Owl_Display* display, uint64_t time_usec, uint32_t key, uint32_t state);
 void owl_seat_send_modifiers(Owl_Display* display);
-void owl_seat_send_pointer_motion(Owl_Display* display, double x, double y);
-void owl_seat_send_pointer_button(Owl_Display* display, uint32_t button, uint32_t state);
+void owl_seat_send_pointer_motion(Owl_Display* display, uint64_t time_usec, double x, double y);
+void owl_seat_send_pointer_button(Owl_Display* display, uint64_t time_usec, uint32_t button, uint32_t state);
+
+const Owl_Format_Info* owl_format_from_shm(uint32_t shm_format);
+const Owl_Format_Info* owl_format_from_drm(uint32_t drm_format);
+const Owl_Format_Info* owl_format_get(int index);
+bool owl_format_resolve_upload(const Owl_Format_Info* info, uint32_t gl_caps, Owl_Format_Upload* upload);
+Owl_Shader_Kind owl_format_dmabuf_shader(const Owl_Format_Info* info);
+int owl_format_plane_stride(const Owl_Format_Info* info, int plane, int32_t stride);
+int owl_format_plane_height(const Owl_Format_Info* info, int plane, int32_t height);
+int owl_format_min_stride(const Owl_Format_Info* info, int32_t width);
+
+void owl_dmabuf_init(Owl_Display* display);
+void owl_dmabuf_cleanup(Owl_Display* display);
+Owl_Dmabuf_Buffer* owl_dmabuf_buffer_from_resource(struct wl_resource* resource);
 
 uint32_t owl_render_upload_texture(Owl_Display* display, Owl_Surface* surface);
 void owl_render_surface(Owl_Display* display, Owl_Surface* surface, int x, int y);
+void owl_render_texture(Owl_Display* display, uint32_t texture_id, Owl_Shader_Kind kind,
+                        int x, int y, int width, int height);
+uint32_t owl_render_create_texture(Owl_Display* display, const uint32_t* argb_pixels,
+                                   int32_t width, int32_t height, Owl_Shader_Kind* kind);
+void owl_render_destroy_texture(Owl_Display* display, uint32_t texture_id);
+void owl_render_release_surface(Owl_Display* display, Owl_Surface* surface);
+void owl_render_trim_textures(Owl_Display* display);
+bool owl_render_make_current(Owl_Display* display);
+bool owl_render_update_thumbnail(Owl_Display* display, Owl_Window* window, int32_t width, int32_t height);
+bool owl_render_read_thumbnail(Owl_Display* display, Owl_Window* window, uint32_t* argb_pixels);
+bool owl_render_update_texture(Owl_Display* display, uint32_t texture_id, const uint32_t* argb_pixels,
+                               int32_t width, int32_t height);
+
+void owl_cursor_init(Owl_Display* display);
+void owl_cursor_cleanup(Owl_Display* display);
+void owl_cursor_update(Owl_Display* display);
+Owl_Cursor_Image* owl_cursor_current_image(Owl_Display* display);
 
 #endif
@@ -0,0 +1,313 @@
+#define _GNU_SOURCE
+#include "internal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <xkbcommon/xkbcommon.h>
+
+#define BINDING_EMPTY 0
+#define BINDING_USED 1
+#define BINDING_DELETED 2
+
+static uint32_t binding_hash(uint32_t mode, uint32_t modifiers, uint32_t keysym, uint32_t flags) {
+    uint32_t hash = keysym * 2654435761u;
+    hash ^= (modifiers | flags << 8 | mode << 16) * 2246822519u;
+    return hash ^ (hash >> 15);
+}
+
+static Owl_Binding* find_binding(Owl_Display* display, uint32_t mode, uint32_t modifiers,
+                                 uint32_t keysym, uint32_t flags) {
+    if (!display->binding_capacity) {
+        return NULL;
+    }
+
+    uint32_t mask = display->binding_capacity - 1;
+    uint32_t slot = binding_hash(mode, modifiers, keysym, flags) & mask;
+    for (uint32_t probe = 0; probe < display->binding_capacity; probe++) {
+        Owl_Binding* binding = &display->bindings[(slot + probe) & mask];
+        if (binding->state == BINDING_EMPTY) {
+            return NULL;
+        }
+        if (binding->state == BINDING_USED && binding->mode == mode &&
+            binding->modifiers == modifiers && binding->keysym == keysym && binding->flags == flags) {
+            return binding;
+        }
+    }
+    return NULL;
+}
+
+static bool insert_binding(Owl_Binding* table, uint32_t capacity, const Owl_Binding* binding,
+                           bool* reused_tombstone) {
+    uint32_t mask = capacity - 1;
+    uint32_t slot = binding_hash(binding->mode, binding->modifiers, binding->keysym, binding->flags) & mask;
+    for (uint32_t probe = 0; probe < capacity; probe++) {
+        Owl_Binding* entry = &table[(slot + probe) & mask];
+        if (entry->state != BINDING_USED) {
+            if (reused_tombstone) {
+                *reused_tombstone = entry->state == BINDING_DELETED;
+            }
+            *entry = *binding;
+            entry->state = BINDING_USED;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool grow_bindings(Owl_Display* display) {
+    uint32_t used = display->binding_count + display->binding_tombstones + 1;
+    if (display->binding_capacity && used * 4 <= display->binding_capacity * 3) {
+        return true;
+    }
+
+    uint32_t capacity = display->binding_capacity ? display->binding_capacity : 32;
+    while ((display->binding_count + 1) * 2 > capacity) {
+        capacity *= 2;
+    }
+
+    Owl_Binding* table = calloc(capacity, sizeof(Owl_Binding));
+    if (!table) {
+        return false;
+    }
+
+    for (uint32_t index = 0; index < display->binding_capacity; index++) {
+        if (display->bindings[index].state == BINDING_USED) {
+            insert_binding(table, capacity, &display->bindings[index], NULL);
+        }
+    }
+
+    free(display->bindings);
+    display->bindings = table;
+    display->binding_capacity = capacity;
+    display->binding_tombstones = 0;
+    return true;
+}
+
+static int find_mode(Owl_Display* display, const char* name) {
+    if (!name || strcmp(name, "default") == 0) {
+        return 0;
+    }
+    for (int index = 1; index < display->binding_mode_count; index++) {
+        if (strcmp(display->binding_modes[index], name) == 0) {
+            return index;
+        }
+    }
+    return -1;
+}
+
+static int intern_mode(Owl_Display* display, const char* name) {
+    int mode = find_mode(display, name);
+    if (mode >= 0) {
+        return mode;
+    }
+    if (display->binding_mode_count >= OWL_MAX_BINDING_MODES) {
+        return -1;
+    }
+
+    if (display->binding_mode_count == 0) {
+        display->binding_modes[0] = NULL;
+        display->binding_mode_count = 1;
+    }
+
+    char* copy = strdup(name);
+    if (!copy) {
+        return -1;
+    }
+    display->binding_modes[display->binding_mode_count] = copy;
+    return display->binding_mode_count++;
+}
+
+static bool key_consumed(Owl_Display* display, uint32_t keycode) {
+    return keycode < OWL_MAX_KEYCODES &&
+           (display->consumed_keys[keycode / 64] & (1ull << (keycode % 64)));
+}
+
+static void set_key_consumed(Owl_Display* display, uint32_t keycode, bool consumed) {
+    if (keycode >= OWL_MAX_KEYCODES) {
+        return;
+    }
+    if (consumed) {
+        display->consumed_keys[keycode / 64] |= 1ull << (keycode % 64);
+    } else {
+        display->consumed_keys[keycode / 64] &= ~(1ull << (keycode % 64));
+    }
+}
+
+static Owl_Binding* lookup(Owl_Display* display, uint32_t modifiers, uint32_t keysym, uint32_t flags) {
+    Owl_Binding* binding = find_binding(display, display->binding_mode, modifiers, keysym, flags);
+    if (!binding) {
+        xkb_keysym_t lower = xkb_keysym_to_lower(keysym);
+        if (lower != keysym) {
+            binding = find_binding(display, display->binding_mode, modifiers, lower, flags);
+        }
+    }
+    return binding;
+}
+
+static void arm_release(Owl_Display* display, uint32_t keycode, const Owl_Binding* binding) {
+    for (int index = 0; index < OWL_MAX_ARMED_RELEASES; index++) {
+        Owl_Armed_Release* armed = &display->armed_releases[index];
+        if (!armed->callback || armed->keycode == keycode) {
+            armed->keycode = keycode;
+            armed->callback = binding->callback;
+            armed->data = binding->data;
+            return;
+        }
+    }
+}
+
+static bool fire_release(Owl_Display* display, uint32_t keycode, Owl_Input* input) {
+    for (int index = 0; index < OWL_MAX_ARMED_RELEASES; index++) {
+        Owl_Armed_Release* armed = &display->armed_releases[index];
+        if (armed->callback && armed->keycode == keycode) {
+            Owl_Binding_Callback callback = armed->callback;
+            void* data = armed->data;
+            armed->callback = NULL;
+            callback(display, input, data);
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool is_modifier_keysym(uint32_t keysym) {
+    return (keysym >= XKB_KEY_Shift_L && keysym <= XKB_KEY_Hyper_R) ||
+           (keysym >= XKB_KEY_ISO_Lock && keysym <= XKB_KEY_ISO_Level5_Lock);
+}
+
+bool owl_keybind_handle(Owl_Display* display, uint32_t keycode, bool pressed, Owl_Input* input) {
+    if (!pressed) {
+        bool consumed = key_consumed(display, keycode);
+        set_key_consumed(display, keycode, false);
+        fire_release(display, keycode, input);
+        return consumed;
+    }
+
+    Owl_Binding* press = lookup(display, input->modifiers, input->keysym, 0);
+    Owl_Binding* release = lookup(display, input->modifiers, input->keysym, OWL_BINDING_RELEASE);
+    if (!press && !release && is_modifier_keysym(input->keysym)) {
+        return false;
+    }
+
+    bool oneshot = display->binding_mode_oneshot;
+    if (oneshot) {
+        display->binding_mode = 0;
+        display->binding_mode_oneshot = false;
+    }
+
+    if (!press && !release) {
+        if (oneshot) {
+            set_key_consumed(display, keycode, true);
+        }
+        return oneshot;
+    }
+
+    set_key_consumed(display, keycode, true);
+    if (release) {
+        arm_release(display, keycode, release);
+    }
+    if (press) {
+        press->callback(display, input, press->data);
+    }
+    return true;
+}
+
+void owl_keybind_cleanup(Owl_Display* display) {
+    free(display->bindings);
+    display->bindings = NULL;
+    display->binding_capacity = 0;
+    display->binding_count = 0;
+    display->binding_tombstones = 0;
+
+    for (int index = 1; index < display->binding_mode_count; index++) {
+        free(display->binding_modes[index]);
+    }
+    display->binding_mode_count = 0;
+    display->binding_mode = 0;
+}
+
+bool owl_bind_key(Owl_Display* display, const char* mode, uint32_t modifiers, uint32_t keysym,
+                  uint32_t flags, Owl_Binding_Callback callback, void* data) {
+    if (!display || !callback) {
+        return false;
+    }
+
+    int mode_index = intern_mode(display, mode);
+    if (mode_index < 0) {
+        return false;
+    }
+
+    flags &= OWL_BINDING_RELEASE;
+    Owl_Binding* existing = find_binding(display, mode_index, modifiers, keysym, flags);
+    if (existing) {
+        existing->callback = callback;
+        existing->data = data;
+        return true;
+    }
+
+    if (!grow_bindings(display)) {
+        return false;
+    }
+
+    Owl_Binding binding = {
+        .mode = mode_index,
+        .modifiers = modifiers,
+        .keysym = keysym,
+        .flags = flags,
+        .callback = callback,
+        .data = data,
+    };
+    bool reused_tombstone = false;
+    if (!insert_binding(display->bindings, display->binding_capacity, &binding, &reused_tombstone)) {
+        return false;
+    }
+    if (reused_tombstone) {
+        display->binding_tombstones--;
+    }
+    display->binding_count++;
+    return true;
+}
+
+bool owl_unbind_key(Owl_Display* display, const char* mode, uint32_t modifiers, uint32_t keysym,
+                    uint32_t flags) {
+    if (!display) {
+        return false;
+    }
+
+    int mode_index = find_mode(display, mode);
+    if (mode_index < 0) {
+        return false;
+    }
+
+    Owl_Binding* binding = find_binding(display, mode_index, modifiers, keysym, flags & OWL_BINDING_RELEASE);
+    if (!binding) {
+        return false;
+    }
+
+    binding->state = BINDING_DELETED;
+    binding->callback = NULL;
+    display->binding_count--;
+    display->binding_tombstones++;
+    return true;
+}
+
+bool owl_set_binding_mode(Owl_Display* display, const char* mode, bool oneshot) {
+    if (!display) {
+        return false;
+    }
+
+    int mode_index = find_mode(display, mode);
+    if (mode_index < 0) {
+        return false;
+    }
+
+    display->binding_mode = mode_index;
+    display->binding_mode_oneshot = oneshot && mode_index != 0;
+    return true;
+}
+
+const char* owl_get_binding_mode(Owl_Display* display) {
+    if (!display || display->binding_mode == 0) {
+        return "default";
+    }
+    return display->binding_modes[display->binding_mode];
+}
@@ -0,0 +1,262 @@
+#include "internal.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+#define LAYOUT_DEFAULT_TIMEOUT_MS 200
+
+static Owl_Layout_Entry* find_entry(Owl_Display* display, Owl_Window* window) {
+    if (!window) {
+        return NULL;
+    }
+
+    Owl_Layout_Entry* entry;
+    wl_array_for_each(entry, &display->layout_entries) {
+        if (entry->window == window) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static Owl_Layout_Entry* get_entry(Owl_Display* display, Owl_Window* window) {
+    Owl_Layout_Entry* entry = find_entry(display, window);
+    if (entry) {
+        return entry;
+    }
+
+    entry = wl_array_add(&display->layout_entries, sizeof(Owl_Layout_Entry));
+    if (!entry) {
+        return NULL;
+    }
+    *entry = (Owl_Layout_Entry){
+        .window = window,
+        .x = window->pos_x,
+        .y = window->pos_y,
+        .width = window->width,
+        .height = window->height,
+    };
+    window->layout_pending = true;
+    return entry;
+}
+
+static void apply_layout(Owl_Display* display) {
+    if (display->layout_timer) {
+        wl_event_source_timer_update(display->layout_timer, 0);
+    }
+    display->layout_in_flight = false;
+
+    struct wl_array entries = display->layout_entries;
+    wl_array_init(&display->layout_entries);
+
+    Owl_Layout_Entry* entry;
+    wl_array_for_each(entry, &entries) {
+        Owl_Window* window = entry->window;
+        if (window) {
+            window->layout_pending = false;
+        }
+    }
+
+    wl_array_for_each(entry, &entries) {
+        Owl_Window* window = entry->window;
+        if (!window) {
+            continue;
+        }
+        if (entry->moved) {
+            window->pos_x = entry->x;
+            window->pos_y = entry->y;
+            owl_spatial_update_window(display, window);
+            owl_stack_sync(window);
+            owl_invoke_window_callback(display, OWL_WINDOW_EVENT_MOVE, window);
+        }
+        if (entry->resized) {
+            owl_surface_release_layout_hold(window);
+            owl_invoke_window_callback(display, OWL_WINDOW_EVENT_RESIZE, window);
+        }
+    }
+
+    wl_array_release(&entries);
+    owl_display_schedule_frame(display);
+}
+
+static void check_layout(Owl_Display* display) {
+    if (!display->layout_in_flight) {
+        return;
+    }
+
+    Owl_Layout_Entry* entry;
+    wl_array_for_each(entry, &display->layout_entries) {
+        if (entry->window && !entry->ready) {
+            return;
+        }
+    }
+    apply_layout(display);
+}
+
+static int handle_layout_timeout(void* data) {
+    Owl_Display* display = data;
+    if (display->layout_in_flight) {
+        fprintf(stderr, "owl: layout transaction timed out, applying anyway\n");
+        apply_layout(display);
+    }
+    return 0;
+}
+
+void owl_layout_init(Owl_Display* display) {
+    wl_array_init(&display->layout_entries);
+    display->layout_timer = wl_event_loop_add_timer(display->event_loop, handle_layout_timeout, display);
+}
+
+void owl_layout_cleanup(Owl_Display* display) {
+    Owl_Layout_Entry* entry;
+    wl_array_for_each(entry, &display->layout_entries) {
+        if (entry->window) {
+            entry->window->layout_pending = false;
+        }
+    }
+    wl_array_release(&display->layout_entries);
+    wl_array_init(&display->layout_entries);
+    display->layout_recording = false;
+    display->layout_in_flight = false;
+
+    if (display->layout_timer) {
+        wl_event_source_remove(display->layout_timer);
+        display->layout_timer = NULL;
+    }
+}
+
+bool owl_layout_record_move(Owl_Window* window, int x, int y) {
+    Owl_Display* display = window->display;
+    if (!display->layout_recording) {
+        return false;
+    }
+
+    Owl_Layout_Entry* entry = get_entry(display, window);
+    if (!entry) {
+        return false;
+    }
+    entry->x = x;
+    entry->y = y;
+    entry->moved = true;
+    return true;
+}
+
+bool owl_layout_record_resize(Owl_Window* window, int width, int height) {
+    Owl_Display* display = window->display;
+    if (!display->layout_recording) {
+        return false;
+    }
+
+    Owl_Layout_Entry* entry = get_entry(display, window);
+    if (!entry) {
+        return false;
+    }
+    entry->width = width;
+    entry->height = height;
+    entry->resized = true;
+    return true;
+}
+
+void owl_layout_configure_acked(Owl_Window* window, uint32_t serial) {
+    Owl_Display* display = window->display;
+    if (!window->layout_pending || !display->layout_in_flight) {
+        return;
+    }
+
+    Owl_Layout_Entry* entry = find_entry(display, window);
+    if (entry && !entry->ready && (int32_t)(serial - entry->serial) >= 0) {
+        entry->acked = true;
+    }
+}
+
+bool owl_layout_holds_buffer(Owl_Window* window) {
+    Owl_Display* display = window->display;
+    if (!window->layout_pending || !display->layout_in_flight || !window->mapped) {
+        return false;
+    }
+
+    Owl_Layout_Entry* entry = find_entry(display, window);
+    return entry && entry->resized;
+}
+
+void owl_layout_surface_committed(Owl_Window* window) {
+    Owl_Display* display = window->display;
+    if (!window->layout_pending || !display->layout_in_flight) {
+        return;
+    }
+
+    Owl_Layout_Entry* entry = find_entry(display, window);
+    if (entry && entry->acked) {
+        entry->ready = true;
+        check_layout(display);
+    }
+}
+
+void owl_layout_window_destroyed(Owl_Window* window) {
+    if (!window->layout_pending) {
+        return;
+    }
+
+    Owl_Display* display = window->display;
+    Owl_Layout_Entry* entry = find_entry(display, window);
+    if (entry) {
+        entry->window = NULL;
+    }
+    window->layout_pending = false;
+    check_layout(display);
+}
+
+void owl_layout_begin(Owl_Display* display) {
+    if (!display || display->layout_recording) {
+        return;
+    }
+
+    if (display->layout_in_flight) {
+        apply_layout(display);
+    }
+    display->layout_recording = true;
+}
+
+void owl_layout_commit(Owl_Display* display, uint32_t timeout_ms) {
+    if (!display || !display->layout_recording) {
+        return;
+    }
+    display->layout_recording = false;
+
+    Owl_Layout_Entry* entry;
+    wl_array_for_each(entry, &display->layout_entries) {
+        Owl_Window* window = entry->window;
+        if (!window) {
+            continue;
+        }
+        if (entry->resized && (entry->width != window->width || entry->height != window->height)) {
+            owl_xdg_toplevel_schedule_configure(window, entry->width, entry->height);
+        }
+    }
+    owl_xdg_flush_configures(display);
+
+    bool waiting = false;
+    wl_array_for_each(entry, &display->layout_entries) {
+        Owl_Window* window = entry->window;
+        if (window && entry->resized && window->mapped && window->pending_configure) {
+            entry->serial = window->pending_serial;
+            waiting = true;
+        } else {
+            entry->ready = true;
+        }
+    }
+
+    display->layout_in_flight = true;
+    if (!waiting) {
+        apply_layout(display);
+        return;
+    }
+
+    if (display->layout_timer) {
+        wl_event_source_timer_update(display->layout_timer,
+                                     (int)(timeout_ms ? timeout_ms : LAYOUT_DEFAULT_TIMEOUT_MS));
+    }
+}
+
+bool owl_layout_in_flight(Owl_Display* display) {
+    return display && display->layout_in_flight;
+}
@@ -0,0 +1,43 @@
+#include "internal.h"
+
+void owl_display_set_texture_budget(Owl_Display* display, uint64_t bytes) {
+    if (!display) {
+        return;
+    }
+    display->texture_budget = bytes;
+    owl_render_trim_textures(display);
+}
+
+void owl_display_get_memory_stats(Owl_Display* display, Owl_Memory_Stats* stats) {
+    if (!stats) {
+        return;
+    }
+    *stats = (Owl_Memory_Stats){ 0 };
+    if (!display) {
+        return;
+    }
+
+    stats->texture_bytes = display->texture_bytes;
+    stats->texture_budget = display->texture_budget;
+    stats->thumbnail_bytes = display->thumbnail_bytes;
+    stats->evictions = display->texture_evictions;
+    stats->restores = display->texture_restores;
+
+    Owl_Client* client;
+    wl_list_for_each(client, &display->clients, link) {
+        stats->shm_bytes += client->shm_bytes;
+    }
+
+    Owl_Surface* surface;
+    wl_list_for_each(surface, &display->surfaces, link) {
+        if (surface->evicted) {
+            stats->evicted_surfaces++;
+        } else if (surface->texture_id) {
+            stats->resident_surfaces++;
+        }
+    }
+}
+
+uint64_t owl_window_get_texture_bytes(Owl_Window* window) {
+    return window && window->surface ? window->surface->texture_bytes : 0;
+}
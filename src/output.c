@@ -66,6 +66,7 @@ static Owl_Output* create_output(Owl_Display* display, drmModeConnector* connect
     output->height = output->drm_mode.vdisplay;
     output->pos_x = crtc->x;
     output->pos_y = crtc->y;
+    output->damage.full = true;
 
     const char* connector_types[] = {
         "Unknown", "VGA", "DVII", "DVID", "DVIA", "Composite", "SVIDEO",
@@ -130,6 +131,10 @@ static void destroy_output(Owl_Output* output) {
         return;
     }
 
+    if (output->frame_idle) {
+        wl_event_source_remove(output->frame_idle);
+    }
+
     if (output->wl_output_global) {
         wl_global_destroy(output->wl_output_global);
     }
@@ -146,10 +151,29 @@ static void destroy_output(Owl_Output* output) {
         gbm_surface_destroy(output->gbm_surface);
     }
 
+    for (int stage = 0; stage < OWL_RENDER_STAGE_COUNT; stage++) {
+        wl_array_release(&output->draw_commands[stage]);
+    }
+
     free(output->name);
     free(output);
 }
 
+static bool add_output(Owl_Display* display, Owl_Output* output) {
+    if (display->output_count == display->output_capacity) {
+        int capacity = display->output_capacity ? display->output_capacity * 2 : 4;
+        Owl_Output** outputs = realloc(display->outputs, (size_t)capacity * sizeof(Owl_Output*));
+        if (!outputs) {
+            return false;
+        }
+        display->outputs = outputs;
+        display->output_capacity = capacity;
+    }
+
+    display->outputs[display->output_count++] = output;
+    return true;
+}
+
 void owl_output_init(Owl_Display* display) {
     drmModeRes* resources = drmModeGetResources(display->drm_fd);
     if (!resources) {
@@ -218,12 +242,11 @@ void owl_output_init(Owl_Display* display) {
             crtc = drmModeGetCrtc(display->drm_fd, encoder->crtc_id ? encoder->crtc_id : resources->crtcs[0]);
         }
 
-        if (display->output_count < OWL_MAX_OUTPUTS) {
-            Owl_Output* output = create_output(display, connector, crtc);
-            if (output) {
-                display->outputs[display->output_count++] = output;
-                owl_invoke_output_callback(display, OWL_OUTPUT_EVENT_CONNECT, output);
-            }
+        Owl_Output* output = create_output(display, connector, crtc);
+        if (output && add_output(display, output)) {
+            owl_invoke_output_callback(display, OWL_OUTPUT_EVENT_CONNECT, output);
+        } else if (output) {
+            destroy_output(output);
         }
 
         drmModeFreeCrtc(crtc);
@@ -241,6 +264,10 @@ void owl_output_cleanup(Owl_Display* display) {
         display->outputs[index] = NULL;
     }
     display->output_count = 0;
+
+    free(display->outputs);
+    display->outputs = NULL;
+    display->output_capacity = 0;
 }
 
 Owl_Output** owl_get_outputs(Owl_Display* display, int* count) {
@@ -271,3 +298,147 @@ int owl_output_get_height(Owl_Output* output) {
 const char* owl_output_get_name(Owl_Output* output) {
     return output ? output->name : NULL;
 }
+
+void owl_damage_clear(Owl_Damage* damage) {
+    damage->count = 0;
+    damage->full = false;
+}
+
+void owl_damage_add(Owl_Damage* damage, int32_t x, int32_t y, int32_t width, int32_t height) {
+    if (damage->full || width <= 0 || height <= 0) {
+        return;
+    }
+
+    if (damage->count < OWL_MAX_DAMAGE_RECTS) {
+        damage->rects[damage->count++] = (Owl_Rect){ x, y, width, height };
+        return;
+    }
+
+    Owl_Rect* bounds = &damage->rects[0];
+    int32_t left = bounds->x < x ? bounds->x : x;
+    int32_t top = bounds->y < y ? bounds->y : y;
+    int32_t right = bounds->x + bounds->width;
+    int32_t bottom = bounds->y + bounds->height;
+    for (int index = 1; index < damage->count; index++) {
+        Owl_Rect* rect = &damage->rects[index];
+        left = rect->x < left ? rect->x : left;
+        top = rect->y < top ? rect->y : top;
+        right = rect->x + rect->width > right ? rect->x + rect->width : right;
+        bottom = rect->y + rect->height > bottom ? rect->y + rect->height : bottom;
+    }
+    right = x + width > right ? x + width : right;
+    bottom = y + height > bottom ? y + height : bottom;
+
+    *bounds = (Owl_Rect){ left, top, right - left, bottom - top };
+    damage->count = 1;
+}
+
+void owl_damage_add_damage(Owl_Damage* damage, const Owl_Damage* other) {
+    if (other->full) {
+        damage->full = true;
+        return;
+    }
+    for (int index = 0; index < other->count; index++) {
+        const Owl_Rect* rect = &other->rects[index];
+        owl_damage_add(damage, rect->x, rect->y, rect->width, rect->height);
+    }
+}
+
+static void output_frame_idle(void* data) {
+    Owl_Output* output = data;
+    output->frame_idle = NULL;
+    if (output->frame_scheduled && !output->page_flip_pending) {
+        owl_render_frame(output->display, output);
+    }
+}
+
+static void request_frame(Owl_Output* output) {
+    output->frame_scheduled = true;
+    if (!output->page_flip_pending && !output->frame_idle) {
+        output->frame_idle = wl_event_loop_add_idle(output->display->event_loop,
+                                                    output_frame_idle, output);
+    }
+}
+
+void owl_output_schedule_frame(Owl_Output* output) {
+    output->damage.full = true;
+    request_frame(output);
+}
+
+void owl_output_damage(Owl_Output* output, int32_t x, int32_t y, int32_t width, int32_t height) {
+    int32_t left = x < 0 ? 0 : x;
+    int32_t top = y < 0 ? 0 : y;
+    int32_t right = x + width > output->width ? output->width : x + width;
+    int32_t bottom = y + height > output->height ? output->height : y + height;
+    if (right <= left || bottom <= top) {
+        return;
+    }
+
+    owl_damage_add(&output->damage, left, top, right - left, bottom - top);
+    request_frame(output);
+}
+
+void owl_output_damage_region(Owl_Output* output, const Owl_Region* region, int32_t dx, int32_t dy) {
+    if (region->count > OWL_MAX_DAMAGE_RECTS) {
+        owl_output_damage(output, region->extents.x + dx, region->extents.y + dy,
+                          region->extents.width, region->extents.height);
+        return;
+    }
+
+    for (int index = 0; index < region->count; index++) {
+        const Owl_Rect* rect = &region->rects[index];
+        owl_output_damage(output, rect->x + dx, rect->y + dy, rect->width, rect->height);
+    }
+}
+
+void owl_display_schedule_frame(Owl_Display* display) {
+    for (int index = 0; index < display->output_count; index++) {
+        owl_output_schedule_frame(display->outputs[index]);
+    }
+}
+
+static bool current_cursor_rect(Owl_Display* display, Owl_Rect* rect) {
+    if (display->cursor_client_set) {
+        Owl_Surface* surface = display->cursor_surface;
+        if (!surface || !surface->has_content) {
+            return false;
+        }
+        *rect = (Owl_Rect){
+            (int32_t)display->pointer_x - display->cursor_hotspot_x,
+            (int32_t)display->pointer_y - display->cursor_hotspot_y,
+            surface->texture_width,
+            surface->texture_height,
+        };
+        return true;
+    }
+
+    Owl_Cursor_Image* image = owl_cursor_current_image(display);
+    if (!image || display->hw_cursor_visible) {
+        return false;
+    }
+    *rect = (Owl_Rect){
+        (int32_t)display->pointer_x - image->hotspot_x,
+        (int32_t)display->pointer_y - image->hotspot_y,
+        image->width,
+        image->height,
+    };
+    return true;
+}
+
+void owl_display_damage_cursor(Owl_Display* display, bool force) {
+    Owl_Rect previous = display->cursor_rect;
+    Owl_Rect next = { 0, 0, 0, 0 };
+    current_cursor_rect(display, &next);
+
+    if (!force && previous.x == next.x && previous.y == next.y &&
+        previous.width == next.width && previous.height == next.height) {
+        return;
+    }
+
+    for (int index = 0; index < display->output_count; index++) {
+        Owl_Output* output = display->outputs[index];
+        owl_output_damage(output, previous.x, previous.y, previous.width, previous.height);
+        owl_output_damage(output, next.x, next.y, next.width, next.height);
+    }
+    display->cursor_rect = next;
+}
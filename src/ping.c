@@ -0,0 +1,170 @@
+#define _GNU_SOURCE
+#include "internal.h"
+#include <stdio.h>
+#include <time.h>
+#include "xdg-shell-protocol.h"
+
+#define PING_DEFAULT_INTERVAL_MS 5000
+#define PING_DEFAULT_TIMEOUT_MS 2000
+
+static uint64_t now_usec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+static int latency_bucket(uint64_t rtt_usec) {
+    uint64_t ms = rtt_usec / 1000;
+    int bucket = 0;
+    while (ms && bucket < OWL_LATENCY_BUCKETS - 1) {
+        ms >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+static void arm_ping_timer(Owl_Display* display) {
+    if (!display->ping_timer) {
+        return;
+    }
+    uint32_t tick = display->ping_interval_ms;
+    if (tick && display->ping_timeout_ms < tick) {
+        tick = display->ping_timeout_ms;
+    }
+    wl_event_source_timer_update(display->ping_timer, (int)tick);
+}
+
+static void set_responding(Owl_Client* client, bool responding) {
+    if (client->not_responding != responding) {
+        return;
+    }
+    client->not_responding = !responding;
+
+    Owl_Display* display = client->display;
+    if (!responding) {
+        fprintf(stderr, "owl: client %p is not responding\n", (void*)client->client);
+    }
+
+    Owl_Window_Event event = responding ? OWL_WINDOW_EVENT_RESPONDING : OWL_WINDOW_EVENT_NOT_RESPONDING;
+    Owl_Window* window;
+    wl_list_for_each(window, &display->windows, link) {
+        if (window->mapped && wl_resource_get_client(window->xdg_surface_resource) == client->client) {
+            owl_invoke_window_callback(display, event, window);
+        }
+    }
+
+    if (responding) {
+        owl_display_schedule_frame(display);
+    }
+}
+
+static void send_ping(Owl_Client* client, uint64_t now) {
+    client->ping_serial = wl_display_next_serial(client->display->wayland_display);
+    client->ping_sent_usec = now;
+    client->ping_pending = true;
+    xdg_wm_base_send_ping(client->wm_base, client->ping_serial);
+}
+
+static int handle_ping_timer(void* data) {
+    Owl_Display* display = data;
+    uint64_t now = now_usec();
+
+    bool waiting = false;
+    Owl_Client* client;
+    wl_list_for_each(client, &display->clients, link) {
+        if (!client->wm_base) {
+            continue;
+        }
+        if (client->ping_pending) {
+            if (now - client->ping_sent_usec >= (uint64_t)display->ping_timeout_ms * 1000) {
+                set_responding(client, false);
+            } else {
+                waiting = true;
+            }
+            continue;
+        }
+        if (display->ping_interval_ms &&
+            now - client->ping_sent_usec >= (uint64_t)display->ping_interval_ms * 1000) {
+            send_ping(client, now);
+        }
+    }
+
+    if (display->ping_interval_ms) {
+        arm_ping_timer(display);
+    } else if (waiting) {
+        wl_event_source_timer_update(display->ping_timer, (int)display->ping_timeout_ms);
+    }
+    return 0;
+}
+
+void owl_ping_init(Owl_Display* display) {
+    display->ping_interval_ms = PING_DEFAULT_INTERVAL_MS;
+    display->ping_timeout_ms = PING_DEFAULT_TIMEOUT_MS;
+    display->ping_timer = wl_event_loop_add_timer(display->event_loop, handle_ping_timer, display);
+    if (!display->ping_timer) {
+        fprintf(stderr, "owl: failed to create ping timer\n");
+        return;
+    }
+    arm_ping_timer(display);
+}
+
+void owl_ping_cleanup(Owl_Display* display) {
+    if (display->ping_timer) {
+        wl_event_source_remove(display->ping_timer);
+        display->ping_timer = NULL;
+    }
+}
+
+void owl_ping_handle_pong(Owl_Client* client, uint32_t serial) {
+    if (!client->ping_pending || serial != client->ping_serial) {
+        return;
+    }
+
+    uint64_t rtt = now_usec() - client->ping_sent_usec;
+    client->ping_pending = false;
+    client->latency_usec = rtt > UINT32_MAX ? UINT32_MAX : (uint32_t)rtt;
+    client->display->latency_histogram[latency_bucket(rtt)]++;
+    set_responding(client, true);
+}
+
+void owl_ping_client(Owl_Client* client) {
+    if (client && client->wm_base && !client->ping_pending) {
+        send_ping(client, now_usec());
+        if (client->display->ping_timer && !client->display->ping_interval_ms) {
+            wl_event_source_timer_update(client->display->ping_timer, (int)client->display->ping_timeout_ms);
+        }
+    }
+}
+
+static Owl_Client* window_client(Owl_Window* window) {
+    return window ? owl_client_from_resource(window->xdg_surface_resource) : NULL;
+}
+
+void owl_window_ping(Owl_Window* window) {
+    owl_ping_client(window_client(window));
+}
+
+bool owl_window_is_responding(Owl_Window* window) {
+    Owl_Client* client = window_client(window);
+    return !client || !client->not_responding;
+}
+
+uint32_t owl_window_get_latency_usec(Owl_Window* window) {
+    Owl_Client* client = window_client(window);
+    return client ? client->latency_usec : 0;
+}
+
+void owl_display_set_ping_interval(Owl_Display* display, uint32_t interval_ms, uint32_t timeout_ms) {
+    if (!display) {
+        return;
+    }
+    display->ping_interval_ms = interval_ms;
+    display->ping_timeout_ms = timeout_ms ? timeout_ms : PING_DEFAULT_TIMEOUT_MS;
+    arm_ping_timer(display);
+}
+
+void owl_display_get_latency_histogram(Owl_Display* display, uint32_t buckets[OWL_LATENCY_BUCKETS]) {
+    for (int index = 0; index < OWL_LATENCY_BUCKETS; index++) {
+        buckets[index] = display ? display->latency_histogram[index] : 0;
+    }
+}
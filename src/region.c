@@ -0,0 +1,233 @@
+#include "internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define REGION_LIMIT (1 << 30)
+
+static bool clip_rect(int32_t x, int32_t y, int32_t width, int32_t height, Owl_Rect* rect) {
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+
+    int64_t left = x < -REGION_LIMIT ? -REGION_LIMIT : x;
+    int64_t top = y < -REGION_LIMIT ? -REGION_LIMIT : y;
+    int64_t right = (int64_t)x + width;
+    int64_t bottom = (int64_t)y + height;
+    right = right > REGION_LIMIT ? REGION_LIMIT : right;
+    bottom = bottom > REGION_LIMIT ? REGION_LIMIT : bottom;
+    if (right <= left || bottom <= top) {
+        return false;
+    }
+
+    *rect = (Owl_Rect){ (int32_t)left, (int32_t)top, (int32_t)(right - left), (int32_t)(bottom - top) };
+    return true;
+}
+
+static bool rects_overlap(const Owl_Rect* a, const Owl_Rect* b) {
+    return a->x < b->x + b->width && b->x < a->x + a->width &&
+           a->y < b->y + b->height && b->y < a->y + a->height;
+}
+
+static bool reserve(Owl_Region* region, int count) {
+    if (count <= region->capacity) {
+        return true;
+    }
+
+    int capacity = region->capacity ? region->capacity * 2 : 4;
+    while (capacity < count) {
+        capacity *= 2;
+    }
+
+    Owl_Rect* rects = realloc(region->rects, (size_t)capacity * sizeof(Owl_Rect));
+    if (!rects) {
+        return false;
+    }
+    region->rects = rects;
+    region->capacity = capacity;
+    return true;
+}
+
+static void update_extents(Owl_Region* region) {
+    if (region->count == 0) {
+        region->extents = (Owl_Rect){ 0, 0, 0, 0 };
+        return;
+    }
+
+    int32_t left = region->rects[0].x;
+    int32_t top = region->rects[0].y;
+    int32_t right = left + region->rects[0].width;
+    int32_t bottom = top + region->rects[0].height;
+    for (int index = 1; index < region->count; index++) {
+        const Owl_Rect* rect = &region->rects[index];
+        left = rect->x < left ? rect->x : left;
+        top = rect->y < top ? rect->y : top;
+        right = rect->x + rect->width > right ? rect->x + rect->width : right;
+        bottom = rect->y + rect->height > bottom ? rect->y + rect->height : bottom;
+    }
+    region->extents = (Owl_Rect){ left, top, right - left, bottom - top };
+}
+
+void owl_region_init(Owl_Region* region) {
+    memset(region, 0, sizeof(Owl_Region));
+}
+
+void owl_region_fini(Owl_Region* region) {
+    free(region->rects);
+    owl_region_init(region);
+}
+
+void owl_region_clear(Owl_Region* region) {
+    region->count = 0;
+    region->extents = (Owl_Rect){ 0, 0, 0, 0 };
+}
+
+bool owl_region_copy(Owl_Region* dst, const Owl_Region* src) {
+    if (dst == src) {
+        return true;
+    }
+    if (!reserve(dst, src->count)) {
+        return false;
+    }
+    if (src->count) {
+        memcpy(dst->rects, src->rects, (size_t)src->count * sizeof(Owl_Rect));
+    }
+    dst->count = src->count;
+    dst->extents = src->extents;
+    return true;
+}
+
+void owl_region_swap(Owl_Region* a, Owl_Region* b) {
+    Owl_Region tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+bool owl_region_is_empty(const Owl_Region* region) {
+    return region->count == 0;
+}
+
+void owl_region_subtract_rect(Owl_Region* region, int32_t x, int32_t y, int32_t width, int32_t height) {
+    Owl_Rect cut;
+    if (!clip_rect(x, y, width, height, &cut) || !rects_overlap(&region->extents, &cut)) {
+        return;
+    }
+
+    int original = region->count;
+    int32_t cut_right = cut.x + cut.width;
+    int32_t cut_bottom = cut.y + cut.height;
+
+    for (int index = 0; index < original; index++) {
+        Owl_Rect rect = region->rects[index];
+        if (!rects_overlap(&rect, &cut)) {
+            continue;
+        }
+
+        int32_t right = rect.x + rect.width;
+        int32_t bottom = rect.y + rect.height;
+        int32_t middle_top = rect.y > cut.y ? rect.y : cut.y;
+        int32_t middle_bottom = bottom < cut_bottom ? bottom : cut_bottom;
+        Owl_Rect pieces[4];
+        int piece_count = 0;
+
+        if (rect.y < cut.y) {
+            pieces[piece_count++] = (Owl_Rect){ rect.x, rect.y, rect.width, cut.y - rect.y };
+        }
+        if (bottom > cut_bottom) {
+            pieces[piece_count++] = (Owl_Rect){ rect.x, cut_bottom, rect.width, bottom - cut_bottom };
+        }
+        if (rect.x < cut.x) {
+            pieces[piece_count++] = (Owl_Rect){ rect.x, middle_top, cut.x - rect.x, middle_bottom - middle_top };
+        }
+        if (right > cut_right) {
+            pieces[piece_count++] = (Owl_Rect){ cut_right, middle_top, right - cut_right, middle_bottom - middle_top };
+        }
+
+        if (!reserve(region, region->count + piece_count)) {
+            continue;
+        }
+        region->rects[index].width = 0;
+        memcpy(&region->rects[region->count], pieces, (size_t)piece_count * sizeof(Owl_Rect));
+        region->count += piece_count;
+    }
+
+    int kept = 0;
+    for (int index = 0; index < region->count; index++) {
+        if (region->rects[index].width > 0) {
+            region->rects[kept++] = region->rects[index];
+        }
+    }
+    region->count = kept;
+    update_extents(region);
+}
+
+void owl_region_add_rect(Owl_Region* region, int32_t x, int32_t y, int32_t width, int32_t height) {
+    Owl_Rect rect;
+    if (!clip_rect(x, y, width, height, &rect)) {
+        return;
+    }
+
+    owl_region_subtract_rect(region, rect.x, rect.y, rect.width, rect.height);
+    if (!reserve(region, region->count + 1)) {
+        return;
+    }
+    region->rects[region->count++] = rect;
+
+    if (region->count == 1) {
+        region->extents = rect;
+        return;
+    }
+
+    int32_t left = region->extents.x < rect.x ? region->extents.x : rect.x;
+    int32_t top = region->extents.y < rect.y ? region->extents.y : rect.y;
+    int32_t right = region->extents.x + region->extents.width;
+    int32_t bottom = region->extents.y + region->extents.height;
+    right = rect.x + rect.width > right ? rect.x + rect.width : right;
+    bottom = rect.y + rect.height > bottom ? rect.y + rect.height : bottom;
+    region->extents = (Owl_Rect){ left, top, right - left, bottom - top };
+}
+
+bool owl_region_contains_point(const Owl_Region* region, int32_t x, int32_t y) {
+    const Owl_Rect* extents = &region->extents;
+    if (region->count == 0 || x < extents->x || x >= extents->x + extents->width ||
+        y < extents->y || y >= extents->y + extents->height) {
+        return false;
+    }
+
+    for (int index = 0; index < region->count; index++) {
+        const Owl_Rect* rect = &region->rects[index];
+        if (x >= rect->x && x < rect->x + rect->width &&
+            y >= rect->y && y < rect->y + rect->height) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool owl_region_contains_rect(const Owl_Region* region, int32_t x, int32_t y, int32_t width, int32_t height) {
+    Owl_Rect target;
+    if (!clip_rect(x, y, width, height, &target)) {
+        return true;
+    }
+
+    const Owl_Rect* extents = &region->extents;
+    if (region->count == 0 || target.x < extents->x || target.y < extents->y ||
+        target.x + target.width > extents->x + extents->width ||
+        target.y + target.height > extents->y + extents->height) {
+        return false;
+    }
+
+    int64_t covered = 0;
+    for (int index = 0; index < region->count; index++) {
+        const Owl_Rect* rect = &region->rects[index];
+        int32_t left = rect->x > target.x ? rect->x : target.x;
+        int32_t top = rect->y > target.y ? rect->y : target.y;
+        int32_t right = rect->x + rect->width < target.x + target.width ?
+                        rect->x + rect->width : target.x + target.width;
+        int32_t bottom = rect->y + rect->height < target.y + target.height ?
+                         rect->y + rect->height : target.y + target.height;
+        if (right > left && bottom > top) {
+            covered += (int64_t)(right - left) * (bottom - top);
+        }
+    }
+    return covered == (int64_t)target.width * target.height;
+}
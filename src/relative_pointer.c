@@ -0,0 +1,113 @@
+#define _GNU_SOURCE
+#include "internal.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <wayland-server-core.h>
+#include <wayland-server-protocol.h>
+#include "relative-pointer-unstable-v1-protocol.h"
+#include "relative-pointer-unstable-v1-protocol.c"
+
+typedef struct Owl_Relative_Pointer {
+    struct wl_resource* resource;
+    struct wl_list link;
+} Owl_Relative_Pointer;
+
+static void relative_pointer_destroy(struct wl_client* client, struct wl_resource* resource) {
+    (void)client;
+    wl_resource_destroy(resource);
+}
+
+static const struct zwp_relative_pointer_v1_interface relative_pointer_interface = {
+    .destroy = relative_pointer_destroy,
+};
+
+static void relative_pointer_destroy_handler(struct wl_resource* resource) {
+    Owl_Relative_Pointer* pointer = wl_resource_get_user_data(resource);
+    if (pointer) {
+        wl_list_remove(&pointer->link);
+        free(pointer);
+    }
+}
+
+static void manager_destroy(struct wl_client* client, struct wl_resource* resource) {
+    (void)client;
+    wl_resource_destroy(resource);
+}
+
+static void manager_get_relative_pointer(struct wl_client* client, struct wl_resource* resource,
+                                         uint32_t id, struct wl_resource* pointer_resource) {
+    (void)pointer_resource;
+    Owl_Client* owner = owl_client_from_wl(client);
+
+    Owl_Relative_Pointer* pointer = calloc(1, sizeof(Owl_Relative_Pointer));
+    if (!pointer) {
+        wl_resource_post_no_memory(resource);
+        return;
+    }
+
+    pointer->resource = wl_resource_create(client, &zwp_relative_pointer_v1_interface,
+                                           wl_resource_get_version(resource), id);
+    if (!pointer->resource) {
+        free(pointer);
+        wl_resource_post_no_memory(resource);
+        return;
+    }
+
+    wl_resource_set_implementation(pointer->resource, &relative_pointer_interface, pointer,
+                                   relative_pointer_destroy_handler);
+    if (owner) {
+        wl_list_insert(&owner->relative_pointers, &pointer->link);
+    } else {
+        wl_list_init(&pointer->link);
+    }
+}
+
+static const struct zwp_relative_pointer_manager_v1_interface manager_interface = {
+    .destroy = manager_destroy,
+    .get_relative_pointer = manager_get_relative_pointer,
+};
+
+static void manager_bind(struct wl_client* client, void* data, uint32_t version, uint32_t id) {
+    Owl_Display* display = data;
+
+    struct wl_resource* resource = wl_resource_create(client, &zwp_relative_pointer_manager_v1_interface,
+                                                      version < 1 ? version : 1, id);
+    if (!resource) {
+        wl_client_post_no_memory(client);
+        return;
+    }
+
+    wl_resource_set_implementation(resource, &manager_interface, display, NULL);
+}
+
+void owl_relative_pointer_init(Owl_Display* display) {
+    display->relative_pointer_manager_global = wl_global_create(display->wayland_display,
+        &zwp_relative_pointer_manager_v1_interface, 1, display, manager_bind);
+
+    if (!display->relative_pointer_manager_global) {
+        fprintf(stderr, "owl: failed to create zwp_relative_pointer_manager_v1 global\n");
+    }
+}
+
+void owl_relative_pointer_cleanup(Owl_Display* display) {
+    if (display->relative_pointer_manager_global) {
+        wl_global_destroy(display->relative_pointer_manager_global);
+        display->relative_pointer_manager_global = NULL;
+    }
+}
+
+void owl_relative_pointer_send_motion(Owl_Display* display, uint64_t time_usec,
+                                      double dx, double dy, double dx_unaccel, double dy_unaccel) {
+    Owl_Client* client = display->pointer_focus_client;
+    if (!display->pointer_focus || !client) {
+        return;
+    }
+
+    Owl_Relative_Pointer* pointer;
+    wl_list_for_each(pointer, &client->relative_pointers, link) {
+        zwp_relative_pointer_v1_send_relative_motion(pointer->resource,
+            (uint32_t)(time_usec >> 32), (uint32_t)time_usec,
+            wl_fixed_from_double(dx), wl_fixed_from_double(dy),
+            wl_fixed_from_double(dx_unaccel), wl_fixed_from_double(dy_unaccel));
+    }
+}
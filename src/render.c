@@ -13,14 +13,20 @@
 #include <xf86drmMode.h>
 #include <wayland-server-protocol.h>
 
-#ifndef GL_BGRA_EXT
-#define GL_BGRA_EXT 0x80E1
-#endif
-
 #ifndef GL_UNPACK_ROW_LENGTH_EXT
 #define GL_UNPACK_ROW_LENGTH_EXT 0x0CF2
 #endif
 
+#ifndef GL_HALF_FLOAT_OES
+#define GL_HALF_FLOAT_OES 0x8D61
+#endif
+
+#ifndef EGL_BUFFER_AGE_EXT
+#define EGL_BUFFER_AGE_EXT 0x313D
+#endif
+
+#define CONVERT_CHUNK_ROWS 32
+
 static FILE* render_log = NULL;
 static void render_debug(const char* fmt, ...) {
     if (!render_log) render_log = fopen("/tmp/owl_render.log", "w");
@@ -56,13 +62,152 @@ static const char* fragment_shader_source =
     "    gl_FragColor = texture2D(texture0, v_texcoord);\n"
     "}\n";
 
-static GLuint shader_program = 0;
-static GLint attr_position = -1;
-static GLint attr_texcoord = -1;
-static GLint uniform_screen_size = -1;
-static GLint uniform_surface_pos = -1;
-static GLint uniform_surface_size = -1;
-static GLint uniform_texture = -1;
+static const char* rgbx_fragment_shader_source =
+    "precision mediump float;\n"
+    "varying vec2 v_texcoord;\n"
+    "uniform sampler2D texture0;\n"
+    "void main() {\n"
+    "    gl_FragColor = vec4(texture2D(texture0, v_texcoord).rgb, 1.0);\n"
+    "}\n";
+
+static const char* bgra_fragment_shader_source =
+    "precision mediump float;\n"
+    "varying vec2 v_texcoord;\n"
+    "uniform sampler2D texture0;\n"
+    "void main() {\n"
+    "    gl_FragColor = texture2D(texture0, v_texcoord).bgra;\n"
+    "}\n";
+
+static const char* bgrx_fragment_shader_source =
+    "precision mediump float;\n"
+    "varying vec2 v_texcoord;\n"
+    "uniform sampler2D texture0;\n"
+    "void main() {\n"
+    "    gl_FragColor = vec4(texture2D(texture0, v_texcoord).bgr, 1.0);\n"
+    "}\n";
+
+static const char* nv12_fragment_shader_source =
+    "precision mediump float;\n"
+    "varying vec2 v_texcoord;\n"
+    "uniform sampler2D texture0;\n"
+    "uniform sampler2D texture1;\n"
+    "uniform mat3 yuv_matrix;\n"
+    "uniform vec3 yuv_offset;\n"
+    "uniform vec4 chroma_v_select;\n"
+    "void main() {\n"
+    "    vec4 chroma = texture2D(texture1, v_texcoord);\n"
+    "    vec3 yuv = vec3(texture2D(texture0, v_texcoord).r, chroma.r, dot(chroma, chroma_v_select));\n"
+    "    gl_FragColor = vec4(yuv_matrix * (yuv - yuv_offset), 1.0);\n"
+    "}\n";
+
+static const char* yuv420_fragment_shader_source =
+    "precision mediump float;\n"
+    "varying vec2 v_texcoord;\n"
+    "uniform sampler2D texture0;\n"
+    "uniform sampler2D texture1;\n"
+    "uniform sampler2D texture2;\n"
+    "uniform mat3 yuv_matrix;\n"
+    "uniform vec3 yuv_offset;\n"
+    "void main() {\n"
+    "    vec3 yuv = vec3(texture2D(texture0, v_texcoord).r,\n"
+    "                    texture2D(texture1, v_texcoord).r,\n"
+    "                    texture2D(texture2, v_texcoord).r);\n"
+    "    gl_FragColor = vec4(yuv_matrix * (yuv - yuv_offset), 1.0);\n"
+    "}\n";
+
+static const char* yuyv_fragment_shader_source =
+    "#ifdef GL_FRAGMENT_PRECISION_HIGH\n"
+    "precision highp float;\n"
+    "#else\n"
+    "precision mediump float;\n"
+    "#endif\n"
+    "varying vec2 v_texcoord;\n"
+    "uniform sampler2D texture0;\n"
+    "uniform float buffer_width;\n"
+    "uniform mat3 yuv_matrix;\n"
+    "uniform vec3 yuv_offset;\n"
+    "void main() {\n"
+    "    vec4 texel = texture2D(texture0, v_texcoord);\n"
+    "    float odd = mod(floor(v_texcoord.x * buffer_width), 2.0);\n"
+    "    vec3 yuv = vec3(mix(texel.r, texel.b, odd), texel.g, texel.a);\n"
+    "    gl_FragColor = vec4(yuv_matrix * (yuv - yuv_offset), 1.0);\n"
+    "}\n";
+
+static const char* solid_vertex_shader_source =
+    "attribute vec2 position;\n"
+    "attribute vec4 color;\n"
+    "varying vec4 v_color;\n"
+    "uniform vec2 screen_size;\n"
+    "void main() {\n"
+    "    vec2 normalized = (position / screen_size) * 2.0 - 1.0;\n"
+    "    normalized.y = -normalized.y;\n"
+    "    gl_Position = vec4(normalized, 0.0, 1.0);\n"
+    "    v_color = color;\n"
+    "}\n";
+
+static const char* solid_fragment_shader_source =
+    "precision mediump float;\n"
+    "varying vec4 v_color;\n"
+    "void main() {\n"
+    "    gl_FragColor = v_color;\n"
+    "}\n";
+
+typedef struct {
+    GLuint program;
+    GLint attr_position;
+    GLint attr_texcoord;
+    GLint uniform_screen_size;
+    GLint uniform_surface_pos;
+    GLint uniform_surface_size;
+    GLint uniform_textures[OWL_MAX_PLANES];
+    GLint uniform_yuv_matrix;
+    GLint uniform_yuv_offset;
+    GLint uniform_chroma_v_select;
+    GLint uniform_buffer_width;
+} Owl_Shader;
+
+static Owl_Shader shaders[OWL_SHADER_COUNT];
+
+typedef struct {
+    GLuint program;
+    GLint attr_position;
+    GLint attr_color;
+    GLint uniform_screen_size;
+} Owl_Solid_Shader;
+
+static Owl_Solid_Shader solid_shader;
+
+static PFNGLEGLIMAGETARGETTEXTURE2DOESPROC image_target_texture = NULL;
+
+static const float bt601_limited_matrix[9] = {
+    1.16438f,  1.16438f, 1.16438f,
+    0.0f,     -0.39176f, 2.01723f,
+    1.59603f, -0.81297f, 0.0f,
+};
+
+static const float bt601_full_matrix[9] = {
+    1.0f,    1.0f,       1.0f,
+    0.0f,   -0.344136f,  1.772f,
+    1.402f, -0.714136f,  0.0f,
+};
+
+static const float bt709_limited_matrix[9] = {
+    1.16438f,  1.16438f, 1.16438f,
+    0.0f,     -0.21325f, 2.11240f,
+    1.79274f, -0.53291f, 0.0f,
+};
+
+static const float bt709_full_matrix[9] = {
+    1.0f,     1.0f,       1.0f,
+    0.0f,    -0.187324f,  1.8556f,
+    1.5748f, -0.468124f,  0.0f,
+};
+
+static const float limited_range_offset[3] = { 16.0f / 255.0f, 128.0f / 255.0f, 128.0f / 255.0f };
+static const float full_range_offset[3] = { 0.0f, 128.0f / 255.0f, 128.0f / 255.0f };
+
+static const float luminance_alpha_v_select[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+static const float red_green_v_select[4] = { 0.0f, 1.0f, 0.0f, 0.0f };
 
 static GLuint quad_vbo = 0;
 
@@ -91,43 +236,110 @@ static GLuint compile_shader(GLenum type, const char* source) {
     return shader;
 }
 
-static bool init_shaders(void) {
-    GLuint vertex_shader = compile_shader(GL_VERTEX_SHADER, vertex_shader_source);
-    if (!vertex_shader) {
+static bool link_shader(Owl_Shader* shader, GLuint vertex_shader, const char* fragment_source) {
+    GLuint fragment_shader = compile_shader(GL_FRAGMENT_SHADER, fragment_source);
+    if (!fragment_shader) {
         return false;
     }
 
-    GLuint fragment_shader = compile_shader(GL_FRAGMENT_SHADER, fragment_shader_source);
-    if (!fragment_shader) {
-        glDeleteShader(vertex_shader);
+    shader->program = glCreateProgram();
+    glAttachShader(shader->program, vertex_shader);
+    glAttachShader(shader->program, fragment_shader);
+    glLinkProgram(shader->program);
+
+    glDeleteShader(fragment_shader);
+
+    GLint status;
+    glGetProgramiv(shader->program, GL_LINK_STATUS, &status);
+    if (!status) {
+        char log[512];
+        glGetProgramInfoLog(shader->program, sizeof(log), NULL, log);
+        fprintf(stderr, "owl: shader link error: %s\n", log);
+        glDeleteProgram(shader->program);
+        shader->program = 0;
         return false;
     }
 
-    shader_program = glCreateProgram();
-    glAttachShader(shader_program, vertex_shader);
-    glAttachShader(shader_program, fragment_shader);
-    glLinkProgram(shader_program);
+    shader->attr_position = glGetAttribLocation(shader->program, "position");
+    shader->attr_texcoord = glGetAttribLocation(shader->program, "texcoord");
+    shader->uniform_screen_size = glGetUniformLocation(shader->program, "screen_size");
+    shader->uniform_surface_pos = glGetUniformLocation(shader->program, "surface_pos");
+    shader->uniform_surface_size = glGetUniformLocation(shader->program, "surface_size");
+    shader->uniform_textures[0] = glGetUniformLocation(shader->program, "texture0");
+    shader->uniform_textures[1] = glGetUniformLocation(shader->program, "texture1");
+    shader->uniform_textures[2] = glGetUniformLocation(shader->program, "texture2");
+    shader->uniform_yuv_matrix = glGetUniformLocation(shader->program, "yuv_matrix");
+    shader->uniform_yuv_offset = glGetUniformLocation(shader->program, "yuv_offset");
+    shader->uniform_chroma_v_select = glGetUniformLocation(shader->program, "chroma_v_select");
+    shader->uniform_buffer_width = glGetUniformLocation(shader->program, "buffer_width");
+
+    return true;
+}
 
+static bool init_solid_shader(void) {
+    GLuint vertex_shader = compile_shader(GL_VERTEX_SHADER, solid_vertex_shader_source);
+    GLuint fragment_shader = compile_shader(GL_FRAGMENT_SHADER, solid_fragment_shader_source);
+    if (!vertex_shader || !fragment_shader) {
+        glDeleteShader(vertex_shader);
+        glDeleteShader(fragment_shader);
+        return false;
+    }
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertex_shader);
+    glAttachShader(program, fragment_shader);
+    glLinkProgram(program);
     glDeleteShader(vertex_shader);
     glDeleteShader(fragment_shader);
 
     GLint status;
-    glGetProgramiv(shader_program, GL_LINK_STATUS, &status);
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
     if (!status) {
-        char log[512];
-        glGetProgramInfoLog(shader_program, sizeof(log), NULL, log);
-        fprintf(stderr, "owl: shader link error: %s\n", log);
-        glDeleteProgram(shader_program);
-        shader_program = 0;
+        fprintf(stderr, "owl: failed to link solid shader\n");
+        glDeleteProgram(program);
+        return false;
+    }
+
+    solid_shader.program = program;
+    solid_shader.attr_position = glGetAttribLocation(program, "position");
+    solid_shader.attr_color = glGetAttribLocation(program, "color");
+    solid_shader.uniform_screen_size = glGetUniformLocation(program, "screen_size");
+    return true;
+}
+
+static bool init_shaders(void) {
+    GLuint vertex_shader = compile_shader(GL_VERTEX_SHADER, vertex_shader_source);
+    if (!vertex_shader) {
+        return false;
+    }
+
+    const char* fragment_sources[OWL_SHADER_COUNT] = {
+        [OWL_SHADER_RGBA] = fragment_shader_source,
+        [OWL_SHADER_RGBX] = rgbx_fragment_shader_source,
+        [OWL_SHADER_BGRA] = bgra_fragment_shader_source,
+        [OWL_SHADER_BGRX] = bgrx_fragment_shader_source,
+        [OWL_SHADER_NV12] = nv12_fragment_shader_source,
+        [OWL_SHADER_YUV420] = yuv420_fragment_shader_source,
+        [OWL_SHADER_YUYV] = yuyv_fragment_shader_source,
+    };
+
+    bool success = true;
+    for (int kind = 0; kind < OWL_SHADER_COUNT; kind++) {
+        if (!link_shader(&shaders[kind], vertex_shader, fragment_sources[kind])) {
+            fprintf(stderr, "owl: failed to build shader variant %d\n", kind);
+            success = kind != OWL_SHADER_RGBA && success;
+        }
+    }
+
+    glDeleteShader(vertex_shader);
+
+    if (!success) {
         return false;
     }
 
-    attr_position = glGetAttribLocation(shader_program, "position");
-    attr_texcoord = glGetAttribLocation(shader_program, "texcoord");
-    uniform_screen_size = glGetUniformLocation(shader_program, "screen_size");
-    uniform_surface_pos = glGetUniformLocation(shader_program, "surface_pos");
-    uniform_surface_size = glGetUniformLocation(shader_program, "surface_size");
-    uniform_texture = glGetUniformLocation(shader_program, "texture0");
+    if (!init_solid_shader()) {
+        fprintf(stderr, "owl: solid fills disabled\n");
+    }
 
     glGenBuffers(1, &quad_vbo);
     glBindBuffer(GL_ARRAY_BUFFER, quad_vbo);
@@ -172,6 +384,30 @@ static uint32_t get_time_ms(void) {
     return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
 }
 
+static uint32_t detect_gl_caps(void) {
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    uint32_t caps = 0;
+
+    if (owl_has_extension(extensions, "GL_EXT_texture_format_BGRA8888")) {
+        caps |= OWL_GL_CAP_BGRA8888;
+    }
+    if (owl_has_extension(extensions, "GL_EXT_texture_type_2_10_10_10_REV")) {
+        caps |= OWL_GL_CAP_TYPE_2_10_10_10_REV;
+    }
+    if (owl_has_extension(extensions, "GL_OES_texture_half_float")) {
+        caps |= OWL_GL_CAP_HALF_FLOAT;
+    }
+    if (owl_has_extension(extensions, "GL_OES_texture_half_float_linear")) {
+        caps |= OWL_GL_CAP_HALF_FLOAT_LINEAR;
+    }
+    if (owl_has_extension(extensions, "GL_OES_texture_npot")) {
+        caps |= OWL_GL_CAP_NPOT_MIPMAP;
+    }
+
+    render_debug("gl caps: 0x%x\n", caps);
+    return caps;
+}
+
 void owl_render_init(Owl_Display* display) {
     if (!eglMakeCurrent(display->egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, display->egl_context)) {
         fprintf(stderr, "owl: failed to make EGL context current for init\n");
@@ -181,95 +417,787 @@ void owl_render_init(Owl_Display* display) {
     if (!init_shaders()) {
         fprintf(stderr, "owl: failed to initialize shaders\n");
     }
+
+    display->gl_caps = detect_gl_caps();
+    display->egl_buffer_age = owl_has_extension(
+        eglQueryString(display->egl_display, EGL_EXTENSIONS), "EGL_EXT_buffer_age");
+
+    image_target_texture = (PFNGLEGLIMAGETARGETTEXTURE2DOESPROC)
+        eglGetProcAddress("glEGLImageTargetTexture2DOES");
 }
 
 void owl_render_cleanup(Owl_Display* display) {
-    (void)display;
+    if (display->thumbnail_fbo) {
+        glDeleteFramebuffers(1, &display->thumbnail_fbo);
+        display->thumbnail_fbo = 0;
+    }
 
     if (quad_vbo) {
         glDeleteBuffers(1, &quad_vbo);
         quad_vbo = 0;
     }
 
-    if (shader_program) {
-        glDeleteProgram(shader_program);
-        shader_program = 0;
+    for (int kind = 0; kind < OWL_SHADER_COUNT; kind++) {
+        if (shaders[kind].program) {
+            glDeleteProgram(shaders[kind].program);
+            shaders[kind].program = 0;
+        }
     }
-}
 
-uint32_t owl_render_upload_texture(Owl_Display* display, Owl_Surface* surface) {
-    if (!surface || !surface->current.buffer) {
-        return 0;
+    if (solid_shader.program) {
+        glDeleteProgram(solid_shader.program);
+        solid_shader.program = 0;
     }
+    wl_array_release(&display->solid_vertices);
+    wl_array_init(&display->solid_vertices);
 
-    Owl_Shm_Buffer* buffer = surface->current.buffer;
-    Owl_Shm_Pool* pool = buffer->pool;
+    free(display->convert_scratch);
+    display->convert_scratch = NULL;
+    display->convert_scratch_size = 0;
+}
 
-    if (!pool || !pool->data) {
-        return 0;
+static void account_texture(Owl_Surface* surface, uint64_t bytes) {
+    Owl_Client* owner = owl_client_from_resource(surface->resource);
+    surface->display->texture_bytes += bytes - surface->texture_bytes;
+    if (owner) {
+        owner->texture_bytes += bytes - surface->texture_bytes;
     }
+    surface->texture_bytes = bytes;
+}
 
-    if (!eglMakeCurrent(display->egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, display->egl_context)) {
-        return 0;
-    }
+static void drop_surface_textures(Owl_Surface* surface) {
+    glDeleteTextures(1, &surface->texture_id);
+    glDeleteTextures(OWL_MAX_PLANES - 1, surface->chroma_texture_ids);
+    surface->texture_id = 0;
+    memset(surface->chroma_texture_ids, 0, sizeof(surface->chroma_texture_ids));
+    account_texture(surface, 0);
+}
 
-    if (surface->texture_id == 0) {
-        glGenTextures(1, &surface->texture_id);
+static GLuint ensure_plane_texture(Owl_Surface* surface, int plane) {
+    uint32_t* texture = plane == 0 ? &surface->texture_id : &surface->chroma_texture_ids[plane - 1];
+    if (*texture == 0) {
+        glGenTextures(1, texture);
     }
+    return *texture;
+}
 
-    glBindTexture(GL_TEXTURE_2D, surface->texture_id);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+static void bind_plane_texture(GLuint texture, GLint filter) {
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+static GLint plane_filter(const Owl_Format_Info* info, int plane) {
+    return info->planes[plane].pixels_per_texel > 1 ? GL_NEAREST : GL_LINEAR;
+}
+
+static GLint upload_filter(const Owl_Format_Upload* upload, uint32_t gl_caps) {
+    if (upload->gl_type == GL_HALF_FLOAT_OES && !(gl_caps & OWL_GL_CAP_HALF_FLOAT_LINEAR)) {
+        return GL_NEAREST;
+    }
+    return GL_LINEAR;
+}
+
+static void damaged_rows(Owl_Surface* surface, int32_t height, int32_t* first, int32_t* last) {
+    *first = 0;
+    *last = height;
+    if (owl_region_is_empty(&surface->current.damage)) {
+        return;
+    }
+
+    int64_t top = surface->current.damage.extents.y;
+    int64_t bottom = top + surface->current.damage.extents.height;
+    *first = top < 0 ? 0 : (top > height ? height : (int32_t)top);
+    *last = bottom < *first ? *first : (bottom > height ? height : (int32_t)bottom);
+}
+
+static bool upload_converted(Owl_Display* display, Owl_Surface* surface, Owl_Shm_Buffer* buffer,
+                             const Owl_Format_Upload* upload, const uint8_t* pixels) {
+    int32_t width = buffer->width;
+    int32_t height = buffer->height;
+    int32_t dst_stride = width * 4;
+    int32_t chunk_rows = CONVERT_CHUNK_ROWS < height ? CONVERT_CHUNK_ROWS : height;
+
+    size_t scratch_size = (size_t)dst_stride * chunk_rows;
+    if (display->convert_scratch_size < scratch_size) {
+        uint8_t* scratch = realloc(display->convert_scratch, scratch_size);
+        if (!scratch) {
+            return false;
+        }
+        display->convert_scratch = scratch;
+        display->convert_scratch_size = scratch_size;
+    }
+
+    bool reuse = surface->texture_id && !surface->stale && !surface->chroma_from_dmabuf &&
+                 surface->texture_format == buffer->format &&
+                 surface->texture_width == width && surface->texture_height == height;
+
+    bind_plane_texture(ensure_plane_texture(surface, 0), upload_filter(upload, display->gl_caps));
+
+    int32_t first = 0;
+    int32_t last = height;
+    if (reuse) {
+        damaged_rows(surface, height, &first, &last);
+    } else {
+        glTexImage2D(GL_TEXTURE_2D, 0, upload->gl_format, width, height,
+                     0, upload->gl_format, upload->gl_type, NULL);
+    }
+
+    for (int32_t row = first; row < last; row += chunk_rows) {
+        int32_t rows = last - row < chunk_rows ? last - row : chunk_rows;
+        owl_convert_rows(upload->convert, display->convert_scratch, dst_stride,
+                         pixels + (size_t)row * buffer->stride, buffer->stride, width, rows);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, row, width, rows,
+                        upload->gl_format, upload->gl_type, display->convert_scratch);
+    }
 
-    void* pixels = (char*)pool->data + buffer->offset;
+    render_debug("converted rows %d-%d of %dx%d buffer\n", first, last, width, height);
+    return true;
+}
+
+static uint64_t upload_planes(Owl_Display* display, Owl_Surface* surface, Owl_Shm_Buffer* buffer,
+                              const Owl_Format_Upload* upload, const char* pixels) {
+    const Owl_Format_Info* info = buffer->format_info;
+    uint64_t bytes = 0;
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for (int plane = 0; plane < info->plane_count; plane++) {
+        const Owl_Format_Plane* format_plane = &info->planes[plane];
+        int32_t stride = owl_format_plane_stride(info, plane, buffer->stride);
+        int32_t height = owl_format_plane_height(info, plane, buffer->height);
+        int32_t pixels_wide = (buffer->width + format_plane->hsub - 1) / format_plane->hsub;
+        int32_t width = (pixels_wide + format_plane->pixels_per_texel - 1) / format_plane->pixels_per_texel;
+
+        GLenum gl_format = format_plane->gl_format;
+        GLenum gl_type = format_plane->gl_type;
+        GLint filter = plane_filter(info, plane);
+        if (plane == 0 && !info->is_yuv) {
+            gl_format = upload->gl_format;
+            gl_type = upload->gl_type;
+            filter = upload_filter(upload, display->gl_caps);
+        }
+
+        bind_plane_texture(ensure_plane_texture(surface, plane), filter);
+
+        glPixelStorei(GL_UNPACK_ROW_LENGTH_EXT, stride / format_plane->bytes_per_texel);
+        glTexImage2D(GL_TEXTURE_2D, 0, gl_format, width, height,
+                     0, gl_format, gl_type, pixels);
+
+        pixels += (size_t)stride * height;
+        bytes += (uint64_t)width * height * format_plane->bytes_per_texel;
+    }
 
-    glPixelStorei(GL_UNPACK_ROW_LENGTH_EXT, buffer->stride / 4);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, buffer->width, buffer->height,
-                 0, GL_BGRA_EXT, GL_UNSIGNED_BYTE, pixels);
     glPixelStorei(GL_UNPACK_ROW_LENGTH_EXT, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    return bytes;
+}
+
+static bool upload_shm_buffer(Owl_Display* display, Owl_Surface* surface, Owl_Shm_Buffer* buffer) {
+    Owl_Shm_Pool* pool = buffer->pool;
+    if (!pool || !pool->data) {
+        return false;
+    }
+
+    const char* pixels = (const char*)pool->data + buffer->offset;
+
+    Owl_Format_Upload upload;
+    if (!owl_format_resolve_upload(buffer->format_info, display->gl_caps, &upload)) {
+        return false;
+    }
+
+    uint64_t bytes;
+    if (upload.convert != OWL_CONVERT_NONE) {
+        if (!upload_converted(display, surface, buffer, &upload, (const uint8_t*)pixels)) {
+            return false;
+        }
+        bytes = (uint64_t)buffer->width * buffer->height * 4;
+    } else {
+        bytes = upload_planes(display, surface, buffer, &upload, pixels);
+    }
+    account_texture(surface, bytes);
 
     surface->texture_width = buffer->width;
     surface->texture_height = buffer->height;
+    surface->texture_format = buffer->format;
+    surface->shader = upload.shader;
+    surface->chroma_from_dmabuf = false;
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
+
+static bool upload_dmabuf_buffer(Owl_Surface* surface, Owl_Dmabuf_Buffer* buffer) {
+    if (!image_target_texture) {
+        return false;
+    }
 
-    wl_buffer_send_release(buffer->resource);
+    const Owl_Format_Info* info = buffer->format_info;
+    int image_count = info->is_yuv ? info->plane_count : 1;
 
-    return surface->texture_id;
+    for (int plane = 0; plane < image_count; plane++) {
+        bind_plane_texture(ensure_plane_texture(surface, plane), plane_filter(info, plane));
+        image_target_texture(GL_TEXTURE_2D, buffer->images[plane]);
+    }
+    account_texture(surface, 0);
+
+    surface->texture_width = buffer->width;
+    surface->texture_height = buffer->height;
+    surface->texture_format = buffer->format;
+    surface->shader = owl_format_dmabuf_shader(info);
+    surface->chroma_from_dmabuf = true;
+
+    return true;
 }
 
-void owl_render_surface(Owl_Display* display, Owl_Surface* surface, int x, int y) {
-    (void)display;
+static Owl_Surface* eviction_candidate(Owl_Display* display) {
+    Owl_Surface* oldest = NULL;
+    Owl_Surface* surface;
+    wl_list_for_each(surface, &display->surfaces, link) {
+        if (!surface->texture_bytes || !surface->current.buffer || surface->buffer_released ||
+            surface == display->cursor_surface ||
+            surface->last_visible >= display->visibility_epoch) {
+            continue;
+        }
+        if (!oldest || surface->last_visible < oldest->last_visible) {
+            oldest = surface;
+        }
+    }
+    return oldest;
+}
 
-    if (!surface || surface->texture_id == 0) {
+static void enforce_texture_budget(Owl_Display* display) {
+    while (display->texture_budget && display->texture_bytes > display->texture_budget) {
+        Owl_Surface* surface = eviction_candidate(display);
+        if (!surface) {
+            break;
+        }
+        render_debug("evicting %llu texture bytes\n", (unsigned long long)surface->texture_bytes);
+        drop_surface_textures(surface);
+        surface->evicted = true;
+        display->texture_evictions++;
+    }
+}
+
+static void release_uploaded_buffer(Owl_Display* display, Owl_Surface* surface) {
+    if (surface->current.buffer && !surface->buffer_released && !display->texture_budget) {
+        wl_buffer_send_release(surface->current.buffer->resource);
+        surface->buffer_released = true;
+    }
+}
+
+static bool restore_surface(Owl_Display* display, Owl_Surface* surface) {
+    if (!surface->current.buffer || surface->buffer_released ||
+        !upload_shm_buffer(display, surface, surface->current.buffer)) {
+        return false;
+    }
+    release_uploaded_buffer(display, surface);
+    if (surface->evicted) {
+        display->texture_restores++;
+    }
+    surface->evicted = false;
+    surface->stale = false;
+    render_debug("restored %dx%d texture\n", surface->texture_width, surface->texture_height);
+    return true;
+}
+
+uint32_t owl_render_upload_texture(Owl_Display* display, Owl_Surface* surface) {
+    if (!surface || (!surface->current.buffer && !surface->current.dmabuf)) {
+        return 0;
+    }
+
+    if (surface->buffer_released && !surface->current.dmabuf) {
+        return surface->texture_id;
+    }
+    if ((surface->evicted || surface->hidden) && !surface->current.dmabuf) {
+        surface->texture_width = surface->current.buffer->width;
+        surface->texture_height = surface->current.buffer->height;
+        surface->texture_format = surface->current.buffer->format;
+        surface->stale = true;
+        return surface->texture_id;
+    }
+
+    if (!eglMakeCurrent(display->egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, display->egl_context)) {
+        return 0;
+    }
+
+    bool uploaded;
+    if (surface->current.dmabuf) {
+        uploaded = upload_dmabuf_buffer(surface, surface->current.dmabuf);
+    } else {
+        uploaded = upload_shm_buffer(display, surface, surface->current.buffer);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    if (!uploaded) {
+        return 0;
+    }
+    release_uploaded_buffer(display, surface);
+    surface->evicted = false;
+    surface->stale = false;
+    surface->last_visible = display->visibility_epoch;
+    enforce_texture_budget(display);
+    return surface->texture_id;
+}
+
+void owl_render_release_surface(Owl_Display* display, Owl_Surface* surface) {
+    if (!eglMakeCurrent(display->egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, display->egl_context)) {
+        account_texture(surface, 0);
         return;
     }
+    drop_surface_textures(surface);
+}
 
-    glUseProgram(shader_program);
+void owl_render_trim_textures(Owl_Display* display) {
+    if (eglMakeCurrent(display->egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, display->egl_context)) {
+        enforce_texture_budget(display);
+    }
+}
 
-    glUniform2f(uniform_surface_pos, (float)x, (float)y);
-    glUniform2f(uniform_surface_size, (float)surface->texture_width, (float)surface->texture_height);
+static void set_yuv_uniforms(Owl_Shader* shader, Owl_Surface* surface) {
+    Owl_Yuv_Encoding encoding = surface->yuv_encoding;
+    if (encoding == OWL_YUV_ENCODING_AUTO) {
+        encoding = surface->texture_height >= 720 ? OWL_YUV_ENCODING_BT709 : OWL_YUV_ENCODING_BT601;
+    }
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, surface->texture_id);
-    glUniform1i(uniform_texture, 0);
+    bool full_range = surface->yuv_range == OWL_YUV_RANGE_FULL;
+    const float* matrix;
+    if (encoding == OWL_YUV_ENCODING_BT709) {
+        matrix = full_range ? bt709_full_matrix : bt709_limited_matrix;
+    } else {
+        matrix = full_range ? bt601_full_matrix : bt601_limited_matrix;
+    }
+
+    glUniformMatrix3fv(shader->uniform_yuv_matrix, 1, GL_FALSE, matrix);
+    glUniform3fv(shader->uniform_yuv_offset, 1, full_range ? full_range_offset : limited_range_offset);
+
+    if (shader->uniform_chroma_v_select >= 0) {
+        glUniform4fv(shader->uniform_chroma_v_select, 1,
+                     surface->chroma_from_dmabuf ? red_green_v_select : luminance_alpha_v_select);
+    }
+
+    if (shader->uniform_buffer_width >= 0) {
+        glUniform1f(shader->uniform_buffer_width, (float)(((surface->texture_width + 1) / 2) * 2));
+    }
+}
+
+static void draw_quad(Owl_Shader* shader, int x, int y, int width, int height) {
+    glUniform2f(shader->uniform_surface_pos, (float)x, (float)y);
+    glUniform2f(shader->uniform_surface_size, (float)width, (float)height);
 
     glBindBuffer(GL_ARRAY_BUFFER, quad_vbo);
-    glEnableVertexAttribArray(attr_position);
-    glEnableVertexAttribArray(attr_texcoord);
-    glVertexAttribPointer(attr_position, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glVertexAttribPointer(attr_texcoord, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+    glEnableVertexAttribArray(shader->attr_position);
+    glEnableVertexAttribArray(shader->attr_texcoord);
+    glVertexAttribPointer(shader->attr_position, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    glVertexAttribPointer(shader->attr_texcoord, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
 
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
-    glDisableVertexAttribArray(attr_position);
-    glDisableVertexAttribArray(attr_texcoord);
+    glDisableVertexAttribArray(shader->attr_position);
+    glDisableVertexAttribArray(shader->attr_texcoord);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+static void draw_surface(Owl_Display* display, Owl_Surface* surface, int x, int y, int width, int height) {
+    if (surface && (surface->evicted || surface->stale)) {
+        restore_surface(display, surface);
+    }
+    if (!surface || surface->texture_id == 0) {
+        return;
+    }
+
+    Owl_Shader* shader = &shaders[surface->shader];
+    if (!shader->program) {
+        return;
+    }
+
+    glUseProgram(shader->program);
+
+    for (int plane = 0; plane < OWL_MAX_PLANES; plane++) {
+        if (shader->uniform_textures[plane] < 0) {
+            continue;
+        }
+        glActiveTexture(GL_TEXTURE0 + plane);
+        glBindTexture(GL_TEXTURE_2D, plane == 0 ? surface->texture_id : surface->chroma_texture_ids[plane - 1]);
+        glUniform1i(shader->uniform_textures[plane], plane);
+    }
+
+    if (shader->uniform_yuv_matrix >= 0) {
+        set_yuv_uniforms(shader, surface);
+    }
+
+    draw_quad(shader, x, y, width, height);
+
+    for (int plane = OWL_MAX_PLANES - 1; plane >= 0; plane--) {
+        if (shader->uniform_textures[plane] >= 0) {
+            glActiveTexture(GL_TEXTURE0 + plane);
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+    }
+}
+
+void owl_render_surface(Owl_Display* display, Owl_Surface* surface, int x, int y) {
+    if (surface) {
+        draw_surface(display, surface, x, y, surface->texture_width, surface->texture_height);
+    }
+}
+
+static bool bind_thumbnail_target(Owl_Display* display, Owl_Window* window) {
+    if (!display->thumbnail_fbo) {
+        glGenFramebuffers(1, &display->thumbnail_fbo);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, display->thumbnail_fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, window->thumbnail_texture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return false;
+    }
+    return true;
+}
+
+bool owl_render_update_thumbnail(Owl_Display* display, Owl_Window* window, int32_t width, int32_t height) {
+    Owl_Surface* surface = window->surface;
+    if (!surface || !surface->has_content || !shaders[surface->shader].program) {
+        return false;
+    }
+
+    bool mipmap = (display->gl_caps & OWL_GL_CAP_NPOT_MIPMAP) ||
+                  ((width & (width - 1)) == 0 && (height & (height - 1)) == 0);
+
+    if (!window->thumbnail_texture || window->thumbnail_width != width || window->thumbnail_height != height) {
+        if (!window->thumbnail_texture) {
+            glGenTextures(1, &window->thumbnail_texture);
+        }
+        bind_plane_texture(window->thumbnail_texture, GL_LINEAR);
+        if (mipmap) {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        }
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        window->thumbnail_width = width;
+        window->thumbnail_height = height;
+    }
+
+    if (!bind_thumbnail_target(display, window)) {
+        return false;
+    }
+
+    glViewport(0, 0, width, height);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glDisable(GL_BLEND);
+
+    Owl_Shader* shader = &shaders[surface->shader];
+    glUseProgram(shader->program);
+    glUniform2f(shader->uniform_screen_size, (float)width, (float)height);
+    draw_surface(display, surface, 0, height, width, -height);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (mipmap) {
+        glBindTexture(GL_TEXTURE_2D, window->thumbnail_texture);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    render_debug("thumbnail %dx%d regenerated\n", width, height);
+    return true;
+}
+
+bool owl_render_read_thumbnail(Owl_Display* display, Owl_Window* window, uint32_t* argb_pixels) {
+    if (!window->thumbnail_texture || !bind_thumbnail_target(display, window)) {
+        return false;
+    }
+
+    glReadPixels(0, 0, window->thumbnail_width, window->thumbnail_height,
+                 GL_RGBA, GL_UNSIGNED_BYTE, argb_pixels);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    size_t count = (size_t)window->thumbnail_width * window->thumbnail_height;
+    const uint8_t* bytes = (const uint8_t*)argb_pixels;
+    for (size_t index = 0; index < count; index++) {
+        const uint8_t* pixel = bytes + index * 4;
+        argb_pixels[index] = (uint32_t)pixel[3] << 24 | (uint32_t)pixel[0] << 16 |
+                             (uint32_t)pixel[1] << 8 | pixel[2];
+    }
+    return true;
+}
+
+void owl_render_texture(Owl_Display* display, uint32_t texture_id, Owl_Shader_Kind kind,
+                        int x, int y, int width, int height) {
+    (void)display;
+
+    Owl_Shader* shader = &shaders[kind];
+    if (!texture_id || !shader->program) {
+        return;
+    }
+
+    glUseProgram(shader->program);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, texture_id);
+    glUniform1i(shader->uniform_textures[0], 0);
+
+    draw_quad(shader, x, y, width, height);
+
     glBindTexture(GL_TEXTURE_2D, 0);
 }
 
+bool owl_render_make_current(Owl_Display* display) {
+    return eglGetCurrentContext() == display->egl_context ||
+           eglMakeCurrent(display->egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, display->egl_context);
+}
+
+uint32_t owl_render_create_texture(Owl_Display* display, const uint32_t* argb_pixels,
+                                   int32_t width, int32_t height, Owl_Shader_Kind* kind) {
+    Owl_Format_Upload upload;
+    if (!owl_format_resolve_upload(owl_format_from_shm(WL_SHM_FORMAT_ARGB8888), display->gl_caps, &upload)) {
+        return 0;
+    }
+
+    if (!owl_render_make_current(display)) {
+        return 0;
+    }
+
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    bind_plane_texture(texture, GL_LINEAR);
+    glTexImage2D(GL_TEXTURE_2D, 0, upload.gl_format, width, height,
+                 0, upload.gl_format, upload.gl_type, argb_pixels);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    *kind = upload.shader;
+    return texture;
+}
+
+bool owl_render_update_texture(Owl_Display* display, uint32_t texture_id, const uint32_t* argb_pixels,
+                               int32_t width, int32_t height) {
+    Owl_Format_Upload upload;
+    if (!texture_id ||
+        !owl_format_resolve_upload(owl_format_from_shm(WL_SHM_FORMAT_ARGB8888), display->gl_caps, &upload) ||
+        !owl_render_make_current(display)) {
+        return false;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, texture_id);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, upload.gl_format, upload.gl_type, argb_pixels);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
+
+void owl_render_destroy_texture(Owl_Display* display, uint32_t texture_id) {
+    if (!texture_id) {
+        return;
+    }
+
+    if (owl_render_make_current(display)) {
+        glDeleteTextures(1, &texture_id);
+    }
+}
+
+static bool rect_intersects(const Owl_Rect* clip, int x, int y, int width, int height) {
+    return !clip || (x < clip->x + clip->width && x + width > clip->x &&
+                     y < clip->y + clip->height && y + height > clip->y);
+}
+
+static void draw_cursor(Owl_Display* display, const Owl_Rect* clip) {
+    Owl_Rect rect = { 0, 0, 0, 0 };
+
+    if (display->cursor_client_set) {
+        Owl_Surface* surface = display->cursor_surface;
+        if (surface && surface->has_content) {
+            rect = (Owl_Rect){
+                (int)display->pointer_x - display->cursor_hotspot_x,
+                (int)display->pointer_y - display->cursor_hotspot_y,
+                surface->texture_width,
+                surface->texture_height,
+            };
+            if (rect_intersects(clip, rect.x, rect.y, rect.width, rect.height)) {
+                owl_render_surface(display, surface, rect.x, rect.y);
+            }
+        }
+    } else if (!display->hw_cursor_visible) {
+        Owl_Cursor_Image* image = owl_cursor_current_image(display);
+        if (image) {
+            rect = (Owl_Rect){
+                (int)display->pointer_x - image->hotspot_x,
+                (int)display->pointer_y - image->hotspot_y,
+                image->width,
+                image->height,
+            };
+            if (rect_intersects(clip, rect.x, rect.y, rect.width, rect.height)) {
+                owl_render_texture(display, image->texture_id, image->shader,
+                                   rect.x, rect.y, rect.width, rect.height);
+            }
+        }
+    }
+
+    display->cursor_rect = rect;
+}
+
+static void flush_solid_rects(Owl_Display* display) {
+    struct wl_array* vertices = &display->solid_vertices;
+    if (!vertices->size) {
+        return;
+    }
+
+    const float* data = vertices->data;
+    glUseProgram(solid_shader.program);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glEnableVertexAttribArray(solid_shader.attr_position);
+    glEnableVertexAttribArray(solid_shader.attr_color);
+    glVertexAttribPointer(solid_shader.attr_position, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(float), data);
+    glVertexAttribPointer(solid_shader.attr_color, 4, GL_FLOAT, GL_FALSE, 6 * sizeof(float), data + 2);
+
+    glDrawArrays(GL_TRIANGLES, 0, (GLsizei)(vertices->size / (6 * sizeof(float))));
+
+    glDisableVertexAttribArray(solid_shader.attr_position);
+    glDisableVertexAttribArray(solid_shader.attr_color);
+    vertices->size = 0;
+}
+
+static void queue_solid_rect(Owl_Display* display, const Owl_Draw_Command* command) {
+    float* vertex = wl_array_add(&display->solid_vertices, 36 * sizeof(float));
+    if (!vertex) {
+        return;
+    }
+
+    float left = (float)command->rect.x;
+    float top = (float)command->rect.y;
+    float right = left + (float)command->rect.width;
+    float bottom = top + (float)command->rect.height;
+    const float corners[6][2] = {
+        { left, top }, { right, top }, { left, bottom },
+        { left, bottom }, { right, top }, { right, bottom },
+    };
+
+    for (int corner = 0; corner < 6; corner++) {
+        vertex[0] = corners[corner][0];
+        vertex[1] = corners[corner][1];
+        memcpy(&vertex[2], command->color, sizeof(command->color));
+        vertex += 6;
+    }
+}
+
+static void draw_commands(Owl_Display* display, const struct wl_array* commands, const Owl_Rect* clip) {
+    const Owl_Draw_Command* command;
+    wl_array_for_each(command, commands) {
+        const Owl_Rect* rect = &command->rect;
+        if (!rect_intersects(clip, rect->x, rect->y, rect->width, rect->height)) {
+            continue;
+        }
+        if (command->kind == OWL_DRAW_RECT) {
+            if (solid_shader.program) {
+                queue_solid_rect(display, command);
+            }
+            continue;
+        }
+        flush_solid_rects(display);
+        owl_render_texture(display, command->texture_id, command->shader,
+                           rect->x, rect->y, rect->width, rect->height);
+    }
+    flush_solid_rects(display);
+}
+
+static void draw_scene(Owl_Display* display, Owl_Output* output, const Owl_Rect* clip) {
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    draw_commands(display, &output->draw_commands[OWL_RENDER_STAGE_BEFORE_WINDOWS], clip);
+
+    const Owl_Window_Stack* stack = &display->stack;
+    const uint8_t visible = OWL_STACK_MAPPED | OWL_STACK_CONTENT;
+    for (int index = 0; index < stack->count; index++) {
+        uint8_t flags = stack->flags[index];
+        if ((flags & visible) != visible || (flags & (OWL_STACK_OCCLUDED | OWL_STACK_HIDDEN))) {
+            continue;
+        }
+        int32_t x = stack->x[index];
+        int32_t y = stack->y[index];
+        if (!rect_intersects(clip, x, y, stack->content_width[index], stack->content_height[index])) {
+            continue;
+        }
+        if (flags & OWL_STACK_OPAQUE) {
+            glDisable(GL_BLEND);
+            owl_render_surface(display, stack->surfaces[index], x, y);
+            glEnable(GL_BLEND);
+        } else {
+            owl_render_surface(display, stack->surfaces[index], x, y);
+        }
+    }
+
+    draw_commands(display, &output->draw_commands[OWL_RENDER_STAGE_AFTER_WINDOWS], clip);
+    draw_cursor(display, clip);
+}
+
+static void update_visibility(Owl_Display* display) {
+    Owl_Rect bounds = { 0, 0, 0, 0 };
+    for (int index = 0; index < display->output_count; index++) {
+        Owl_Output* output = display->outputs[index];
+        if (output->width > bounds.width) {
+            bounds.width = output->width;
+        }
+        if (output->height > bounds.height) {
+            bounds.height = output->height;
+        }
+    }
+
+    display->visibility_epoch++;
+
+    Owl_Region covered;
+    owl_region_init(&covered);
+
+    Owl_Window_Stack* stack = &display->stack;
+    const uint8_t visible = OWL_STACK_MAPPED | OWL_STACK_CONTENT;
+    for (int index = stack->count - 1; index >= 0; index--) {
+        uint8_t flags = stack->flags[index] & ~OWL_STACK_OCCLUDED;
+        stack->flags[index] = flags;
+        if ((flags & visible) != visible || (flags & OWL_STACK_HIDDEN)) {
+            continue;
+        }
+
+        int32_t x = stack->x[index];
+        int32_t y = stack->y[index];
+        int32_t width = stack->content_width[index];
+        int32_t height = stack->content_height[index];
+        if (!rect_intersects(&bounds, x, y, width, height) ||
+            owl_region_contains_rect(&covered, x, y, width, height)) {
+            stack->flags[index] = flags | OWL_STACK_OCCLUDED;
+            continue;
+        }
+
+        stack->surfaces[index]->last_visible = display->visibility_epoch;
+        if (flags & OWL_STACK_OPAQUE) {
+            owl_region_add_rect(&covered, x, y, width, height);
+        }
+    }
+
+    owl_region_fini(&covered);
+}
+
+static void collect_repaint_damage(Owl_Display* display, Owl_Output* output, Owl_Damage* repaint) {
+    *repaint = output->damage;
+
+    EGLint age = 0;
+    if (display->egl_buffer_age &&
+        !eglQuerySurface(display->egl_display, output->egl_surface, EGL_BUFFER_AGE_EXT, &age)) {
+        age = 0;
+    }
+
+    if (age <= 0 || age > OWL_DAMAGE_HISTORY + 1) {
+        repaint->full = true;
+    } else {
+        for (int frame = 1; frame < age; frame++) {
+            int slot = (output->damage_history_index - frame + OWL_DAMAGE_HISTORY) % OWL_DAMAGE_HISTORY;
+            owl_damage_add_damage(repaint, &output->damage_history[slot]);
+        }
+    }
+
+    output->damage_history[output->damage_history_index] = output->damage;
+    output->damage_history_index = (output->damage_history_index + 1) % OWL_DAMAGE_HISTORY;
+    owl_damage_clear(&output->damage);
+}
+
 void owl_render_frame(Owl_Display* display, Owl_Output* output) {
     if (!display || !output) {
         render_debug("render_frame: null display or output\n");
@@ -280,6 +1208,12 @@ void owl_render_frame(Owl_Display* display, Owl_Output* output) {
         render_debug("render_frame: page_flip_pending, skipping\n");
         return;
     }
+
+    output->frame_scheduled = false;
+    if (!output->damage.full && output->damage.count == 0) {
+        render_debug("render_frame: no damage, skipping\n");
+        return;
+    }
     render_debug("render_frame: starting\n");
 
     if (!eglMakeCurrent(display->egl_display, output->egl_surface,
@@ -288,40 +1222,41 @@ void owl_render_frame(Owl_Display* display, Owl_Output* output) {
         return;
     }
 
+    update_visibility(display);
+    enforce_texture_budget(display);
+    owl_invoke_render_hooks(display, output);
+
+    Owl_Damage repaint;
+    collect_repaint_damage(display, output, &repaint);
+
     glViewport(0, 0, output->width, output->height);
     glClearColor(0.2f, 0.2f, 0.3f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
 
     glEnable(GL_BLEND);
     glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 
-    glUseProgram(shader_program);
-    glUniform2f(uniform_screen_size, (float)output->width, (float)output->height);
-
-    int window_count = 0;
-    int rendered_count = 0;
-    Owl_Window* window;
-    wl_list_for_each_reverse(window, &display->windows, link) {
-        window_count++;
-        render_debug("  window %p: mapped=%d surface=%p has_content=%d\n",
-                     (void*)window, window->mapped,
-                     (void*)window->surface,
-                     window->surface ? window->surface->has_content : 0);
-        if (window->mapped && window->surface && window->surface->has_content) {
-            render_debug("    rendering at %d,%d size=%dx%d\n",
-                         window->pos_x, window->pos_y,
-                         window->surface->texture_width, window->surface->texture_height);
-            owl_render_surface(display, window->surface, window->pos_x, window->pos_y);
-            rendered_count++;
+    for (int kind = 0; kind < OWL_SHADER_COUNT; kind++) {
+        if (shaders[kind].program) {
+            glUseProgram(shaders[kind].program);
+            glUniform2f(shaders[kind].uniform_screen_size, (float)output->width, (float)output->height);
         }
     }
-    render_debug("render_frame: windows=%d rendered=%d\n", window_count, rendered_count);
+    if (solid_shader.program) {
+        glUseProgram(solid_shader.program);
+        glUniform2f(solid_shader.uniform_screen_size, (float)output->width, (float)output->height);
+    }
 
-    if (display->cursor_surface && display->cursor_surface->has_content) {
-        int cursor_x = (int)display->pointer_x - display->cursor_hotspot_x;
-        int cursor_y = (int)display->pointer_y - display->cursor_hotspot_y;
-        owl_render_surface(display, display->cursor_surface, cursor_x, cursor_y);
-        render_debug("render_frame: cursor at %d,%d\n", cursor_x, cursor_y);
+    if (repaint.full) {
+        draw_scene(display, output, NULL);
+    } else {
+        glEnable(GL_SCISSOR_TEST);
+        for (int index = 0; index < repaint.count; index++) {
+            const Owl_Rect* rect = &repaint.rects[index];
+            glScissor(rect->x, output->height - rect->y - rect->height, rect->width, rect->height);
+            draw_scene(display, output, rect);
+        }
+        glDisable(GL_SCISSOR_TEST);
+        render_debug("render_frame: partial repaint, %d rects\n", repaint.count);
     }
 
     glDisable(GL_BLEND);
@@ -0,0 +1,140 @@
+#include "internal.h"
+#include <stdlib.h>
+
+static inline int32_t cell_of(int32_t coordinate) {
+    return coordinate >= 0 ? coordinate / OWL_GRID_CELL_SIZE
+                           : -((-coordinate - 1) / OWL_GRID_CELL_SIZE) - 1;
+}
+
+static inline uint32_t bucket_of(int32_t cell_x, int32_t cell_y) {
+    uint32_t hash = (uint32_t)cell_x * 73856093u ^ (uint32_t)cell_y * 19349663u;
+    return hash % OWL_GRID_BUCKETS;
+}
+
+static void bucket_insert(struct wl_array* bucket, Owl_Window* window) {
+    Owl_Window** entry;
+    wl_array_for_each(entry, bucket) {
+        if (*entry == window) {
+            return;
+        }
+    }
+
+    entry = wl_array_add(bucket, sizeof(Owl_Window*));
+    if (entry) {
+        *entry = window;
+    }
+}
+
+static void bucket_remove(struct wl_array* bucket, Owl_Window* window) {
+    Owl_Window** entries = bucket->data;
+    size_t count = bucket->size / sizeof(Owl_Window*);
+    for (size_t index = 0; index < count; index++) {
+        if (entries[index] == window) {
+            entries[index] = entries[count - 1];
+            bucket->size -= sizeof(Owl_Window*);
+            return;
+        }
+    }
+}
+
+static void for_each_bucket(Owl_Display* display, Owl_Window* window, bool insert) {
+    int64_t cells = (int64_t)(window->grid_x1 - window->grid_x0 + 1) *
+                    (window->grid_y1 - window->grid_y0 + 1);
+
+    if (cells >= OWL_GRID_BUCKETS) {
+        for (int bucket = 0; bucket < OWL_GRID_BUCKETS; bucket++) {
+            if (insert) {
+                bucket_insert(&display->window_grid[bucket], window);
+            } else {
+                bucket_remove(&display->window_grid[bucket], window);
+            }
+        }
+        return;
+    }
+
+    for (int32_t cell_y = window->grid_y0; cell_y <= window->grid_y1; cell_y++) {
+        for (int32_t cell_x = window->grid_x0; cell_x <= window->grid_x1; cell_x++) {
+            struct wl_array* bucket = &display->window_grid[bucket_of(cell_x, cell_y)];
+            if (insert) {
+                bucket_insert(bucket, window);
+            } else {
+                bucket_remove(bucket, window);
+            }
+        }
+    }
+}
+
+void owl_spatial_init(Owl_Display* display) {
+    for (int bucket = 0; bucket < OWL_GRID_BUCKETS; bucket++) {
+        wl_array_init(&display->window_grid[bucket]);
+    }
+}
+
+void owl_spatial_cleanup(Owl_Display* display) {
+    for (int bucket = 0; bucket < OWL_GRID_BUCKETS; bucket++) {
+        wl_array_release(&display->window_grid[bucket]);
+        wl_array_init(&display->window_grid[bucket]);
+    }
+}
+
+void owl_spatial_remove_window(Owl_Display* display, Owl_Window* window) {
+    if (!window->grid_indexed) {
+        return;
+    }
+    for_each_bucket(display, window, false);
+    window->grid_indexed = false;
+}
+
+void owl_spatial_update_window(Owl_Display* display, Owl_Window* window) {
+    if (!window->mapped || window->hidden || window->width <= 0 || window->height <= 0) {
+        owl_spatial_remove_window(display, window);
+        return;
+    }
+
+    int32_t x0 = cell_of(window->pos_x);
+    int32_t y0 = cell_of(window->pos_y);
+    int32_t x1 = cell_of(window->pos_x + window->width - 1);
+    int32_t y1 = cell_of(window->pos_y + window->height - 1);
+
+    if (window->grid_indexed && x0 == window->grid_x0 && y0 == window->grid_y0 &&
+        x1 == window->grid_x1 && y1 == window->grid_y1) {
+        return;
+    }
+
+    owl_spatial_remove_window(display, window);
+
+    window->grid_x0 = x0;
+    window->grid_y0 = y0;
+    window->grid_x1 = x1;
+    window->grid_y1 = y1;
+    for_each_bucket(display, window, true);
+    window->grid_indexed = true;
+}
+
+Owl_Window* owl_spatial_window_at(Owl_Display* display, int32_t point_x, int32_t point_y) {
+    struct wl_array* bucket = &display->window_grid[bucket_of(cell_of(point_x), cell_of(point_y))];
+
+    Owl_Window* best = NULL;
+    Owl_Window** entry;
+    wl_array_for_each(entry, bucket) {
+        Owl_Window* window = *entry;
+        if (point_x < window->pos_x || point_x >= window->pos_x + window->width ||
+            point_y < window->pos_y || point_y >= window->pos_y + window->height) {
+            continue;
+        }
+        if (best && window->stack_index < best->stack_index) {
+            continue;
+        }
+
+        Owl_Surface* surface = window->surface;
+        if (surface && !surface->current.input_infinite &&
+            !owl_region_contains_point(&surface->current.input_region,
+                                       point_x - window->pos_x, point_y - window->pos_y)) {
+            continue;
+        }
+        if (!best || window->stack_index > best->stack_index) {
+            best = window;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,188 @@
+#include "internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+static bool grow_stack(Owl_Window_Stack* stack) {
+    if (stack->count < stack->capacity) {
+        return true;
+    }
+
+    int capacity = stack->capacity ? stack->capacity * 2 : 16;
+    size_t pointers = sizeof(Owl_Window*) + sizeof(Owl_Surface*);
+    size_t scalars = 6 * sizeof(int32_t);
+    char* block = malloc((size_t)capacity * (pointers + scalars + sizeof(uint8_t)));
+    if (!block) {
+        return false;
+    }
+
+    Owl_Window_Stack grown = { .count = stack->count, .capacity = capacity };
+    grown.windows = (Owl_Window**)block;
+    grown.surfaces = (Owl_Surface**)(grown.windows + capacity);
+    grown.x = (int32_t*)(grown.surfaces + capacity);
+    grown.y = grown.x + capacity;
+    grown.width = grown.y + capacity;
+    grown.height = grown.width + capacity;
+    grown.content_width = grown.height + capacity;
+    grown.content_height = grown.content_width + capacity;
+    grown.flags = (uint8_t*)(grown.content_height + capacity);
+
+    size_t count = (size_t)stack->count;
+    if (count) {
+        memcpy(grown.windows, stack->windows, count * sizeof(Owl_Window*));
+        memcpy(grown.surfaces, stack->surfaces, count * sizeof(Owl_Surface*));
+        memcpy(grown.x, stack->x, count * sizeof(int32_t));
+        memcpy(grown.y, stack->y, count * sizeof(int32_t));
+        memcpy(grown.width, stack->width, count * sizeof(int32_t));
+        memcpy(grown.height, stack->height, count * sizeof(int32_t));
+        memcpy(grown.content_width, stack->content_width, count * sizeof(int32_t));
+        memcpy(grown.content_height, stack->content_height, count * sizeof(int32_t));
+        memcpy(grown.flags, stack->flags, count * sizeof(uint8_t));
+    }
+
+    free(stack->windows);
+    *stack = grown;
+    return true;
+}
+
+static void store_slot(Owl_Window_Stack* stack, int index, Owl_Window* window) {
+    Owl_Surface* surface = window->surface;
+    uint8_t flags = 0;
+    if (window->mapped) {
+        flags |= OWL_STACK_MAPPED;
+    }
+    if (window->hidden) {
+        flags |= OWL_STACK_HIDDEN;
+    }
+    if (surface && surface->has_content) {
+        flags |= OWL_STACK_CONTENT;
+        if (surface->opaque) {
+            flags |= OWL_STACK_OPAQUE;
+        }
+    }
+
+    stack->windows[index] = window;
+    stack->surfaces[index] = surface;
+    stack->x[index] = window->pos_x;
+    stack->y[index] = window->pos_y;
+    stack->width[index] = window->width;
+    stack->height[index] = window->height;
+    stack->content_width[index] = surface ? surface->texture_width : 0;
+    stack->content_height[index] = surface ? surface->texture_height : 0;
+    stack->flags[index] = flags;
+    window->stack_index = index;
+}
+
+static void shift_slots(Owl_Window_Stack* stack, int to, int from, int count) {
+    if (count <= 0) {
+        return;
+    }
+    memmove(&stack->windows[to], &stack->windows[from], (size_t)count * sizeof(Owl_Window*));
+    memmove(&stack->surfaces[to], &stack->surfaces[from], (size_t)count * sizeof(Owl_Surface*));
+    memmove(&stack->x[to], &stack->x[from], (size_t)count * sizeof(int32_t));
+    memmove(&stack->y[to], &stack->y[from], (size_t)count * sizeof(int32_t));
+    memmove(&stack->width[to], &stack->width[from], (size_t)count * sizeof(int32_t));
+    memmove(&stack->height[to], &stack->height[from], (size_t)count * sizeof(int32_t));
+    memmove(&stack->content_width[to], &stack->content_width[from], (size_t)count * sizeof(int32_t));
+    memmove(&stack->content_height[to], &stack->content_height[from], (size_t)count * sizeof(int32_t));
+    memmove(&stack->flags[to], &stack->flags[from], (size_t)count * sizeof(uint8_t));
+
+    for (int index = to; index < to + count; index++) {
+        stack->windows[index]->stack_index = index;
+    }
+}
+
+static bool move_slot(Owl_Window_Stack* stack, int from, int to) {
+    if (from == to) {
+        return false;
+    }
+
+    Owl_Window* window = stack->windows[from];
+    if (from < to) {
+        shift_slots(stack, from, from + 1, to - from);
+    } else {
+        shift_slots(stack, to + 1, to, from - to);
+    }
+    store_slot(stack, to, window);
+    return true;
+}
+
+static void stack_changed(Owl_Window* window) {
+    if (window->mapped) {
+        owl_display_schedule_frame(window->display);
+    }
+}
+
+bool owl_stack_insert(Owl_Display* display, Owl_Window* window) {
+    Owl_Window_Stack* stack = &display->stack;
+    if (!grow_stack(stack)) {
+        return false;
+    }
+    store_slot(stack, stack->count++, window);
+    return true;
+}
+
+void owl_stack_remove(Owl_Display* display, Owl_Window* window) {
+    Owl_Window_Stack* stack = &display->stack;
+    int index = window->stack_index;
+    if (index < 0 || index >= stack->count || stack->windows[index] != window) {
+        return;
+    }
+    shift_slots(stack, index, index + 1, stack->count - index - 1);
+    stack->count--;
+    window->stack_index = -1;
+}
+
+void owl_stack_sync(Owl_Window* window) {
+    Owl_Window_Stack* stack = &window->display->stack;
+    int index = window->stack_index;
+    if (index >= 0 && index < stack->count && stack->windows[index] == window) {
+        store_slot(stack, index, window);
+    }
+}
+
+void owl_stack_cleanup(Owl_Display* display) {
+    free(display->stack.windows);
+    memset(&display->stack, 0, sizeof(display->stack));
+}
+
+void owl_window_raise(Owl_Window* window) {
+    if (!window || window->stack_index < 0) {
+        return;
+    }
+    Owl_Window_Stack* stack = &window->display->stack;
+    if (move_slot(stack, window->stack_index, stack->count - 1)) {
+        stack_changed(window);
+    }
+}
+
+void owl_window_lower(Owl_Window* window) {
+    if (!window || window->stack_index < 0) {
+        return;
+    }
+    if (move_slot(&window->display->stack, window->stack_index, 0)) {
+        stack_changed(window);
+    }
+}
+
+void owl_window_restack(Owl_Window* window, Owl_Window* sibling, bool above) {
+    if (!window || !sibling || window == sibling || window->display != sibling->display ||
+        window->stack_index < 0 || sibling->stack_index < 0) {
+        return;
+    }
+
+    int from = window->stack_index;
+    int to = sibling->stack_index;
+    if (above && from > to) {
+        to++;
+    } else if (!above && from < to) {
+        to--;
+    }
+
+    if (move_slot(&window->display->stack, from, to)) {
+        stack_changed(window);
+    }
+}
+
+int owl_window_get_stack_index(Owl_Window* window) {
+    return window ? window->stack_index : -1;
+}
@@ -21,6 +21,20 @@ static void surf_debug(const char* fmt, ...) {
     }
 }
 
+static void release_pool(Owl_Shm_Pool* pool) {
+    Owl_Client* owner = owl_client_from_wl(pool->client);
+    if (owner) {
+        owner->shm_bytes -= (uint64_t)pool->size;
+    }
+    if (pool->data) {
+        munmap(pool->data, pool->size);
+    }
+    if (pool->fd >= 0) {
+        close(pool->fd);
+    }
+    free(pool);
+}
+
 static void shm_pool_destroy_handler(struct wl_resource* resource) {
     Owl_Shm_Pool* pool = wl_resource_get_user_data(resource);
     if (!pool) {
@@ -29,13 +43,7 @@ static void shm_pool_destroy_handler(struct wl_resource* resource) {
 
     pool->ref_count--;
     if (pool->ref_count <= 0) {
-        if (pool->data) {
-            munmap(pool->data, pool->size);
-        }
-        if (pool->fd >= 0) {
-            close(pool->fd);
-        }
-        free(pool);
+        release_pool(pool);
     }
 }
 
@@ -48,13 +56,7 @@ static void shm_buffer_destroy_handler(struct wl_resource* resource) {
     if (buffer->pool) {
         buffer->pool->ref_count--;
         if (buffer->pool->ref_count <= 0 && buffer->pool->resource == NULL) {
-            if (buffer->pool->data) {
-                munmap(buffer->pool->data, buffer->pool->size);
-            }
-            if (buffer->pool->fd >= 0) {
-                close(buffer->pool->fd);
-            }
-            free(buffer->pool);
+            release_pool(buffer->pool);
         }
     }
 
@@ -79,18 +81,25 @@ static void shm_pool_create_buffer(struct wl_client* client, struct wl_resource*
         return;
     }
 
-    if (offset < 0 || width <= 0 || height <= 0 || stride < width * 4) {
-        wl_resource_post_error(resource, WL_SHM_ERROR_INVALID_STRIDE, "invalid buffer parameters");
+    const Owl_Format_Info* info = owl_format_from_shm(format);
+    if (!info || !owl_format_resolve_upload(info, pool->display->gl_caps, NULL)) {
+        wl_resource_post_error(resource, WL_SHM_ERROR_INVALID_FORMAT, "unsupported format");
         return;
     }
 
-    if (offset + stride * height > pool->size) {
-        wl_resource_post_error(resource, WL_SHM_ERROR_INVALID_STRIDE, "buffer extends past pool");
+    if (offset < 0 || width <= 0 || height <= 0 || stride < owl_format_min_stride(info, width)) {
+        wl_resource_post_error(resource, WL_SHM_ERROR_INVALID_STRIDE, "invalid buffer parameters");
         return;
     }
 
-    if (format != WL_SHM_FORMAT_ARGB8888 && format != WL_SHM_FORMAT_XRGB8888) {
-        wl_resource_post_error(resource, WL_SHM_ERROR_INVALID_FORMAT, "unsupported format");
+    int64_t end = offset;
+    for (int plane = 0; plane < info->plane_count; plane++) {
+        end += (int64_t)owl_format_plane_stride(info, plane, stride) *
+               owl_format_plane_height(info, plane, height);
+    }
+
+    if (end > pool->size) {
+        wl_resource_post_error(resource, WL_SHM_ERROR_INVALID_STRIDE, "buffer extends past pool");
         return;
     }
 
@@ -106,6 +115,7 @@ static void shm_pool_create_buffer(struct wl_client* client, struct wl_resource*
     buffer->height = height;
     buffer->stride = stride;
     buffer->format = format;
+    buffer->format_info = info;
     buffer->busy = false;
 
     pool->ref_count++;
@@ -131,7 +141,6 @@ static void shm_pool_destroy(struct wl_client* client, struct wl_resource* resou
 }
 
 static void shm_pool_resize(struct wl_client* client, struct wl_resource* resource, int32_t size) {
-    (void)client;
     Owl_Shm_Pool* pool = wl_resource_get_user_data(resource);
     if (!pool) {
         return;
@@ -142,12 +151,21 @@ static void shm_pool_resize(struct wl_client* client, struct wl_resource* resour
         return;
     }
 
+    Owl_Client* owner = owl_client_from_wl(client);
+    if (owner && owl_client_quota_exceeded(owner, owner->shm_bytes + (uint64_t)(size - pool->size),
+                                           pool->display->client_quota.max_shm_bytes, "shm quota exceeded")) {
+        return;
+    }
+
     void* new_data = mremap(pool->data, pool->size, size, MREMAP_MAYMOVE);
     if (new_data == MAP_FAILED) {
         wl_resource_post_error(resource, WL_SHM_ERROR_INVALID_FD, "failed to resize pool");
         return;
     }
 
+    if (owner) {
+        owner->shm_bytes += (uint64_t)(size - pool->size);
+    }
     pool->data = new_data;
     pool->size = size;
 }
@@ -168,6 +186,13 @@ static void shm_create_pool(struct wl_client* client, struct wl_resource* resour
         return;
     }
 
+    Owl_Client* owner = owl_client_from_wl(client);
+    if (owner && owl_client_quota_exceeded(owner, owner->shm_bytes + (uint64_t)size,
+                                           display->client_quota.max_shm_bytes, "shm quota exceeded")) {
+        close(fd);
+        return;
+    }
+
     Owl_Shm_Pool* pool = calloc(1, sizeof(Owl_Shm_Pool));
     if (!pool) {
         close(fd);
@@ -176,6 +201,7 @@ static void shm_create_pool(struct wl_client* client, struct wl_resource* resour
     }
 
     pool->display = display;
+    pool->client = client;
     pool->fd = fd;
     pool->size = size;
     pool->ref_count = 1;
@@ -198,6 +224,9 @@ static void shm_create_pool(struct wl_client* client, struct wl_resource* resour
     }
 
     wl_resource_set_implementation(pool->resource, &shm_pool_interface, pool, shm_pool_destroy_handler);
+    if (owner) {
+        owner->shm_bytes += (uint64_t)size;
+    }
 }
 
 static const struct wl_shm_interface shm_interface = {
@@ -216,16 +245,78 @@ static void shm_bind(struct wl_client* client, void* data, uint32_t version, uin
 
     wl_resource_set_implementation(resource, &shm_interface, display, NULL);
 
-    wl_shm_send_format(resource, WL_SHM_FORMAT_ARGB8888);
-    wl_shm_send_format(resource, WL_SHM_FORMAT_XRGB8888);
+    const Owl_Format_Info* info;
+    for (int index = 0; (info = owl_format_get(index)) != NULL; index++) {
+        if (owl_format_resolve_upload(info, display->gl_caps, NULL)) {
+            wl_shm_send_format(resource, info->shm_format);
+        }
+    }
+}
+
+static void surface_state_buffer_destroyed(struct wl_listener* listener, void* data) {
+    (void)data;
+    Owl_Surface_State* state = wl_container_of(listener, state, buffer_destroy);
+    wl_list_remove(&listener->link);
+    wl_list_init(&listener->link);
+    state->buffer = NULL;
+}
+
+static void surface_state_set_buffer(Owl_Surface_State* state, Owl_Shm_Buffer* buffer) {
+    if (state->buffer == buffer) {
+        return;
+    }
+
+    wl_list_remove(&state->buffer_destroy.link);
+    wl_list_init(&state->buffer_destroy.link);
+    state->buffer = buffer;
+
+    if (buffer) {
+        wl_resource_add_destroy_listener(buffer->resource, &state->buffer_destroy);
+    }
+}
+
+static void surface_state_dmabuf_destroyed(struct wl_listener* listener, void* data) {
+    (void)data;
+    Owl_Surface_State* state = wl_container_of(listener, state, dmabuf_destroy);
+    wl_list_remove(&listener->link);
+    wl_list_init(&listener->link);
+    state->dmabuf = NULL;
+}
+
+static void surface_state_set_dmabuf(Owl_Surface_State* state, Owl_Dmabuf_Buffer* dmabuf) {
+    if (state->dmabuf == dmabuf) {
+        return;
+    }
+
+    wl_list_remove(&state->dmabuf_destroy.link);
+    wl_list_init(&state->dmabuf_destroy.link);
+    state->dmabuf = dmabuf;
+
+    if (dmabuf) {
+        wl_resource_add_destroy_listener(dmabuf->resource, &state->dmabuf_destroy);
+    }
 }
 
 static void surface_state_init(Owl_Surface_State* state) {
     memset(state, 0, sizeof(Owl_Surface_State));
     wl_list_init(&state->frame_callbacks);
+    state->buffer_destroy.notify = surface_state_buffer_destroyed;
+    wl_list_init(&state->buffer_destroy.link);
+    state->dmabuf_destroy.notify = surface_state_dmabuf_destroyed;
+    wl_list_init(&state->dmabuf_destroy.link);
+    owl_region_init(&state->damage);
+    owl_region_init(&state->opaque_region);
+    owl_region_init(&state->input_region);
+    state->input_infinite = true;
 }
 
 static void surface_state_cleanup(Owl_Surface_State* state) {
+    surface_state_set_buffer(state, NULL);
+    surface_state_set_dmabuf(state, NULL);
+    owl_region_fini(&state->damage);
+    owl_region_fini(&state->opaque_region);
+    owl_region_fini(&state->input_region);
+
     Owl_Frame_Callback* callback;
     Owl_Frame_Callback* tmp;
     wl_list_for_each_safe(callback, tmp, &state->frame_callbacks, link) {
@@ -234,6 +325,16 @@ static void surface_state_cleanup(Owl_Surface_State* state) {
     }
 }
 
+static Owl_Window* find_window_for_surface(Owl_Display* display, Owl_Surface* surface) {
+    Owl_Window* window;
+    wl_list_for_each(window, &display->windows, link) {
+        if (window->surface == surface) {
+            return window;
+        }
+    }
+    return NULL;
+}
+
 static void surface_destroy_handler(struct wl_resource* resource) {
     Owl_Surface* surface = wl_resource_get_user_data(resource);
     if (!surface) {
@@ -245,11 +346,31 @@ static void surface_destroy_handler(struct wl_resource* resource) {
     }
     if (surface->display->keyboard_focus == surface) {
         surface->display->keyboard_focus = NULL;
+        surface->display->keyboard_focus_client = NULL;
     }
     if (surface->display->pointer_focus == surface) {
         surface->display->pointer_focus = NULL;
+        surface->display->pointer_focus_client = NULL;
     }
 
+    Owl_Window* window = find_window_for_surface(surface->display, surface);
+    if (window) {
+        window->surface = NULL;
+        owl_stack_sync(window);
+    }
+
+    Owl_Client* owner = owl_client_from_resource(resource);
+    if (owner) {
+        owner->surface_count--;
+        owner->frame_callbacks -= (uint32_t)(wl_list_length(&surface->pending.frame_callbacks) +
+                                             wl_list_length(&surface->current.frame_callbacks));
+    }
+
+    if (surface->current.buffer && !surface->buffer_released) {
+        wl_buffer_send_release(surface->current.buffer->resource);
+    }
+    owl_render_release_surface(surface->display, surface);
+
     wl_list_remove(&surface->link);
     surface->display->surface_count--;
 
@@ -272,7 +393,10 @@ static void surface_attach(struct wl_client* client, struct wl_resource* resourc
         return;
     }
 
-    surface->pending.buffer = buffer_resource ? wl_resource_get_user_data(buffer_resource) : NULL;
+    Owl_Dmabuf_Buffer* dmabuf = owl_dmabuf_buffer_from_resource(buffer_resource);
+    surface_state_set_dmabuf(&surface->pending, dmabuf);
+    surface_state_set_buffer(&surface->pending,
+                             buffer_resource && !dmabuf ? wl_resource_get_user_data(buffer_resource) : NULL);
     surface->pending.buffer_x = x;
     surface->pending.buffer_y = y;
     surface->pending.buffer_attached = true;
@@ -286,11 +410,13 @@ static void surface_damage(struct wl_client* client, struct wl_resource* resourc
         return;
     }
 
-    surface->pending.damage_x = x;
-    surface->pending.damage_y = y;
-    surface->pending.damage_width = width;
-    surface->pending.damage_height = height;
-    surface->pending.has_damage = true;
+    Owl_Region* damage = &surface->pending.damage;
+    owl_region_add_rect(damage, x, y, width, height);
+    if (damage->count > OWL_MAX_DAMAGE_RECTS) {
+        Owl_Rect extents = damage->extents;
+        owl_region_clear(damage);
+        owl_region_add_rect(damage, extents.x, extents.y, extents.width, extents.height);
+    }
 }
 
 static void surface_frame(struct wl_client* client, struct wl_resource* resource, uint32_t callback_id) {
@@ -299,6 +425,13 @@ static void surface_frame(struct wl_client* client, struct wl_resource* resource
         return;
     }
 
+    Owl_Client* owner = owl_client_from_wl(client);
+    if (owner && owl_client_quota_exceeded(owner, owner->frame_callbacks + 1ull,
+                                           surface->display->client_quota.max_frame_callbacks,
+                                           "frame callback quota exceeded")) {
+        return;
+    }
+
     Owl_Frame_Callback* callback = calloc(1, sizeof(Owl_Frame_Callback));
     if (!callback) {
         wl_resource_post_no_memory(resource);
@@ -314,30 +447,67 @@ static void surface_frame(struct wl_client* client, struct wl_resource* resource
 
     wl_resource_set_implementation(callback->resource, NULL, callback, NULL);
     wl_list_insert(surface->pending.frame_callbacks.prev, &callback->link);
+    if (owner) {
+        owner->frame_callbacks++;
+    }
 }
 
 static void surface_set_opaque_region(struct wl_client* client, struct wl_resource* resource,
                                       struct wl_resource* region) {
     (void)client;
-    (void)resource;
-    (void)region;
+    Owl_Surface* surface = wl_resource_get_user_data(resource);
+    if (!surface) {
+        return;
+    }
+
+    if (region) {
+        if (!owl_region_copy(&surface->pending.opaque_region, wl_resource_get_user_data(region))) {
+            wl_resource_post_no_memory(resource);
+            return;
+        }
+    } else {
+        owl_region_clear(&surface->pending.opaque_region);
+    }
+    surface->pending.opaque_region_changed = true;
 }
 
 static void surface_set_input_region(struct wl_client* client, struct wl_resource* resource,
                                      struct wl_resource* region) {
     (void)client;
-    (void)resource;
-    (void)region;
-}
+    Owl_Surface* surface = wl_resource_get_user_data(resource);
+    if (!surface) {
+        return;
+    }
 
-static Owl_Window* find_window_for_surface(Owl_Display* display, Owl_Surface* surface) {
-    Owl_Window* window;
-    wl_list_for_each(window, &display->windows, link) {
-        if (window->surface == surface) {
-            return window;
+    if (region) {
+        if (!owl_region_copy(&surface->pending.input_region, wl_resource_get_user_data(region))) {
+            wl_resource_post_no_memory(resource);
+            return;
         }
+    } else {
+        owl_region_clear(&surface->pending.input_region);
+    }
+    surface->pending.input_infinite = region == NULL;
+    surface->pending.input_region_changed = true;
+}
+
+static void upload_surface(Owl_Surface* surface) {
+    owl_render_upload_texture(surface->display, surface);
+    surface->has_content = true;
+    surface->opaque = owl_region_contains_rect(&surface->current.opaque_region, 0, 0,
+                                               surface->texture_width, surface->texture_height);
+}
+
+void owl_surface_release_layout_hold(Owl_Window* window) {
+    Owl_Surface* surface = window->surface;
+    if (!surface || !surface->layout_held) {
+        return;
+    }
+    surface->layout_held = false;
+    if (surface->current.buffer || surface->current.dmabuf) {
+        upload_surface(surface);
+        owl_stack_sync(window);
     }
-    return NULL;
 }
 
 static void surface_commit(struct wl_client* client, struct wl_resource* resource) {
@@ -349,35 +519,62 @@ static void surface_commit(struct wl_client* client, struct wl_resource* resourc
         return;
     }
 
-    if (surface->pending.buffer_attached) {
+    bool attached = surface->pending.buffer_attached;
+    if (attached) {
         surf_debug("  attaching buffer\n");
-        surface->current.buffer = surface->pending.buffer;
+        Owl_Dmabuf_Buffer* previous = surface->current.dmabuf;
+        if (previous && previous != surface->pending.dmabuf) {
+            wl_buffer_send_release(previous->resource);
+        }
+        Owl_Shm_Buffer* retained = surface->current.buffer;
+        if (retained && retained != surface->pending.buffer && !surface->buffer_released) {
+            wl_buffer_send_release(retained->resource);
+        }
+        surface->buffer_released = false;
+        surface_state_set_buffer(&surface->current, surface->pending.buffer);
+        surface_state_set_buffer(&surface->pending, NULL);
+        surface_state_set_dmabuf(&surface->current, surface->pending.dmabuf);
+        surface_state_set_dmabuf(&surface->pending, NULL);
         surface->current.buffer_x = surface->pending.buffer_x;
         surface->current.buffer_y = surface->pending.buffer_y;
         surface->pending.buffer_attached = false;
     }
 
-    if (surface->pending.has_damage) {
+    if (!owl_region_is_empty(&surface->pending.damage)) {
         surf_debug("  has damage\n");
-        surface->current.damage_x = surface->pending.damage_x;
-        surface->current.damage_y = surface->pending.damage_y;
-        surface->current.damage_width = surface->pending.damage_width;
-        surface->current.damage_height = surface->pending.damage_height;
-        surface->current.has_damage = true;
-        surface->pending.has_damage = false;
+        owl_region_swap(&surface->current.damage, &surface->pending.damage);
+        owl_region_clear(&surface->pending.damage);
+    }
+
+    if (surface->pending.opaque_region_changed) {
+        owl_region_copy(&surface->current.opaque_region, &surface->pending.opaque_region);
+        surface->pending.opaque_region_changed = false;
+    }
+
+    if (surface->pending.input_region_changed) {
+        owl_region_copy(&surface->current.input_region, &surface->pending.input_region);
+        surface->current.input_infinite = surface->pending.input_infinite;
+        surface->pending.input_region_changed = false;
     }
 
     wl_list_insert_list(&surface->current.frame_callbacks, &surface->pending.frame_callbacks);
     wl_list_init(&surface->pending.frame_callbacks);
 
-    if (surface->current.buffer) {
-        surf_debug("  uploading texture\n");
-        owl_render_upload_texture(surface->display, surface);
-        surf_debug("  texture uploaded\n");
-        surface->has_content = true;
-
+    if (surface->current.buffer || surface->current.dmabuf) {
+        int32_t previous_width = surface->texture_width;
+        int32_t previous_height = surface->texture_height;
+        bool had_content = surface->has_content;
         Owl_Window* window = find_window_for_surface(surface->display, surface);
         surf_debug("  window=%p\n", (void*)window);
+
+        surface->layout_held = window && surface->current.buffer && owl_layout_holds_buffer(window);
+        if (surface->layout_held) {
+            surf_debug("  holding buffer for layout transaction\n");
+        } else {
+            surf_debug("  uploading texture\n");
+            upload_surface(surface);
+            surf_debug("  texture uploaded\n");
+        }
         if (window && window->xdg_toplevel_resource && !window->mapped) {
             surf_debug("  mapping window\n");
             if (window->width == 0 && window->height == 0) {
@@ -387,15 +584,33 @@ static void surface_commit(struct wl_client* client, struct wl_resource* resourc
             owl_window_map(window);
             surf_debug("  window mapped\n");
         }
+        if (window) {
+            if (attached) {
+                owl_thumbnail_mark_dirty(window);
+            }
+            owl_stack_sync(window);
+            owl_layout_surface_committed(window);
+        }
 
-        surf_debug("  rendering frames\n");
-        for (int index = 0; index < surface->display->output_count; index++) {
-            owl_render_frame(surface->display, surface->display->outputs[index]);
+        if (window && window->hidden) {
+            surf_debug("  window hidden, skipping damage\n");
+        } else if (surface->layout_held) {
+            surf_debug("  buffer held, skipping damage\n");
+        } else if (window && window->mapped && had_content &&
+            previous_width == surface->texture_width && previous_height == surface->texture_height &&
+            !owl_region_is_empty(&surface->current.damage)) {
+            for (int index = 0; index < surface->display->output_count; index++) {
+                owl_output_damage_region(surface->display->outputs[index], &surface->current.damage,
+                                         window->pos_x, window->pos_y);
+            }
+        } else {
+            owl_display_schedule_frame(surface->display);
         }
-        surf_debug("  frames rendered\n");
     } else {
         surf_debug("  no buffer\n");
     }
+    owl_region_clear(&surface->current.damage);
+    owl_workspace_surface_committed(surface);
 }
 
 static void surface_set_buffer_transform(struct wl_client* client, struct wl_resource* resource,
@@ -443,6 +658,12 @@ static void compositor_create_surface(struct wl_client* client, struct wl_resour
                                       uint32_t id) {
     Owl_Display* display = wl_resource_get_user_data(resource);
 
+    Owl_Client* owner = owl_client_from_wl(client);
+    if (owner && owl_client_quota_exceeded(owner, owner->surface_count + 1ull,
+                                           display->client_quota.max_surfaces, "surface quota exceeded")) {
+        return;
+    }
+
     Owl_Surface* surface = calloc(1, sizeof(Owl_Surface));
     if (!surface) {
         wl_resource_post_no_memory(resource);
@@ -465,12 +686,21 @@ static void compositor_create_surface(struct wl_client* client, struct wl_resour
 
     wl_list_insert(&display->surfaces, &surface->link);
     display->surface_count++;
+    if (owner) {
+        owner->surface_count++;
+    }
 
     fprintf(stderr, "owl: surface created (total: %d)\n", display->surface_count);
 }
 
 static void region_destroy_handler(struct wl_resource* resource) {
-    (void)resource;
+    Owl_Region* region = wl_resource_get_user_data(resource);
+    if (!region) {
+        return;
+    }
+
+    owl_region_fini(region);
+    free(region);
 }
 
 static void region_destroy(struct wl_client* client, struct wl_resource* resource) {
@@ -481,21 +711,15 @@ static void region_destroy(struct wl_client* client, struct wl_resource* resourc
 static void region_add(struct wl_client* client, struct wl_resource* resource,
                        int32_t x, int32_t y, int32_t width, int32_t height) {
     (void)client;
-    (void)resource;
-    (void)x;
-    (void)y;
-    (void)width;
-    (void)height;
+    Owl_Region* region = wl_resource_get_user_data(resource);
+    owl_region_add_rect(region, x, y, width, height);
 }
 
 static void region_subtract(struct wl_client* client, struct wl_resource* resource,
                             int32_t x, int32_t y, int32_t width, int32_t height) {
     (void)client;
-    (void)resource;
-    (void)x;
-    (void)y;
-    (void)width;
-    (void)height;
+    Owl_Region* region = wl_resource_get_user_data(resource);
+    owl_region_subtract_rect(region, x, y, width, height);
 }
 
 static const struct wl_region_interface region_interface = {
@@ -506,13 +730,21 @@ static const struct wl_region_interface region_interface = {
 
 static void compositor_create_region(struct wl_client* client, struct wl_resource* resource,
                                      uint32_t id) {
+    Owl_Region* region = calloc(1, sizeof(Owl_Region));
+    if (!region) {
+        wl_resource_post_no_memory(resource);
+        return;
+    }
+
     struct wl_resource* region_resource = wl_resource_create(client, &wl_region_interface, 1, id);
     if (!region_resource) {
+        free(region);
         wl_resource_post_no_memory(resource);
         return;
     }
 
-    wl_resource_set_implementation(region_resource, &region_interface, NULL, region_destroy_handler);
+    owl_region_init(region);
+    wl_resource_set_implementation(region_resource, &region_interface, region, region_destroy_handler);
 }
 
 static const struct wl_compositor_interface compositor_interface = {
@@ -827,13 +1059,24 @@ Owl_Surface* owl_surface_from_resource(struct wl_resource* resource) {
     return wl_resource_get_user_data(resource);
 }
 
-void owl_surface_send_frame_done(Owl_Display* display, uint32_t time) {
+static void send_frame_done(Owl_Display* display, uint32_t time, bool hidden) {
     Owl_Surface* surface;
     wl_list_for_each(surface, &display->surfaces, link) {
+        if (surface->hidden != hidden || wl_list_empty(&surface->current.frame_callbacks)) {
+            continue;
+        }
+        Owl_Client* client = owl_client_from_resource(surface->resource);
+        if (owl_client_throttled(client)) {
+            continue;
+        }
+
         Owl_Frame_Callback* callback;
         Owl_Frame_Callback* tmp;
         wl_list_for_each_safe(callback, tmp, &surface->current.frame_callbacks, link) {
             wl_callback_send_done(callback->resource, time);
+            if (client) {
+                client->frame_callbacks--;
+            }
             wl_resource_destroy(callback->resource);
             wl_list_remove(&callback->link);
             free(callback);
@@ -841,29 +1084,73 @@ void owl_surface_send_frame_done(Owl_Display* display, uint32_t time) {
     }
 }
 
+void owl_surface_send_frame_done(Owl_Display* display, uint32_t time) {
+    send_frame_done(display, time, false);
+}
+
+void owl_surface_send_hidden_frame_done(Owl_Display* display, uint32_t time) {
+    send_frame_done(display, time, true);
+}
+
+void owl_windows_changed(Owl_Display* display) {
+    display->window_snapshot_dirty = true;
+}
+
+static bool rebuild_window_snapshot(Owl_Display* display) {
+    if (display->window_count > display->window_snapshot_capacity) {
+        int capacity = display->window_snapshot_capacity ? display->window_snapshot_capacity : 16;
+        while (capacity < display->window_count) {
+            capacity *= 2;
+        }
+        Owl_Window** windows = realloc(display->window_snapshot, (size_t)capacity * sizeof(Owl_Window*));
+        if (!windows) {
+            return false;
+        }
+        display->window_snapshot = windows;
+        display->window_snapshot_capacity = capacity;
+    }
+
+    int index = 0;
+    Owl_Window* window;
+    wl_list_for_each(window, &display->windows, link) {
+        if (window->mapped) {
+            display->window_snapshot[index++] = window;
+        }
+    }
+
+    display->window_snapshot_count = index;
+    display->window_snapshot_dirty = false;
+    return true;
+}
+
 Owl_Window** owl_get_windows(Owl_Display* display, int* count) {
     if (!display || !count) {
         if (count) *count = 0;
         return NULL;
     }
 
-    *count = display->window_count;
-    if (display->window_count == 0) {
+    if (display->window_snapshot_dirty && !rebuild_window_snapshot(display)) {
+        *count = 0;
         return NULL;
     }
 
-    static Owl_Window* window_array[OWL_MAX_WINDOWS];
-    int index = 0;
+    *count = display->window_snapshot_count;
+    return display->window_snapshot_count ? display->window_snapshot : NULL;
+}
 
-    Owl_Window* window;
-    wl_list_for_each(window, &display->windows, link) {
-        if (index < OWL_MAX_WINDOWS && window->mapped) {
-            window_array[index++] = window;
-        }
+Owl_Window* owl_display_next_window(Owl_Display* display, Owl_Window* previous) {
+    if (!display) {
+        return NULL;
     }
 
-    *count = index;
-    return window_array;
+    struct wl_list* link = previous ? previous->link.next : display->windows.next;
+    for (; link != &display->windows; link = link->next) {
+        Owl_Window* window = wl_container_of(link, window, link);
+        if (window->mapped) {
+            return window;
+        }
+    }
+    return NULL;
 }
 
 void owl_window_focus(Owl_Window* window) {
@@ -876,13 +1163,13 @@ void owl_window_focus(Owl_Window* window) {
         if (other->focused && other != window) {
             other->focused = false;
             owl_invoke_window_callback(window->display, OWL_WINDOW_EVENT_UNFOCUS, other);
-            owl_xdg_toplevel_send_configure(other, other->width, other->height);
+            owl_xdg_toplevel_schedule_configure(other, other->width, other->height);
         }
     }
 
     window->focused = true;
     owl_invoke_window_callback(window->display, OWL_WINDOW_EVENT_FOCUS, window);
-    owl_xdg_toplevel_send_configure(window, window->width, window->height);
+    owl_xdg_toplevel_schedule_configure(window, window->width, window->height);
 
     if (window->surface) {
         owl_seat_set_keyboard_focus(window->display, window->surface);
@@ -893,8 +1180,14 @@ void owl_window_move(Owl_Window* window, int x, int y) {
     if (!window) {
         return;
     }
+    if (owl_layout_record_move(window, x, y)) {
+        return;
+    }
     window->pos_x = x;
     window->pos_y = y;
+    owl_spatial_update_window(window->display, window);
+    owl_stack_sync(window);
+    owl_display_schedule_frame(window->display);
     owl_invoke_window_callback(window->display, OWL_WINDOW_EVENT_MOVE, window);
 }
 
@@ -902,7 +1195,10 @@ void owl_window_resize(Owl_Window* window, int width, int height) {
     if (!window) {
         return;
     }
-    owl_xdg_toplevel_send_configure(window, width, height);
+    if (owl_layout_record_resize(window, width, height)) {
+        return;
+    }
+    owl_xdg_toplevel_schedule_configure(window, width, height);
     owl_invoke_window_callback(window->display, OWL_WINDOW_EVENT_RESIZE, window);
 }
 
@@ -918,9 +1214,18 @@ void owl_window_set_fullscreen(Owl_Window* window, bool fullscreen) {
         return;
     }
     window->fullscreen = fullscreen;
+    owl_xdg_toplevel_schedule_configure(window, window->width, window->height);
     owl_invoke_window_callback(window->display, OWL_WINDOW_EVENT_FULLSCREEN, window);
 }
 
+void owl_window_set_yuv_encoding(Owl_Window* window, Owl_Yuv_Encoding encoding, Owl_Yuv_Range range) {
+    if (!window || !window->surface) {
+        return;
+    }
+    window->surface->yuv_encoding = encoding;
+    window->surface->yuv_range = range;
+}
+
 int owl_window_get_x(Owl_Window* window) {
     return window ? window->pos_x : 0;
 }
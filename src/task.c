@@ -0,0 +1,136 @@
+#define _GNU_SOURCE
+#include "internal.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#define TASK_BATCH_LIMIT 1024
+
+static void push_task(Owl_Display* display, Owl_Task* task) {
+    atomic_store_explicit(&task->next, NULL, memory_order_relaxed);
+    Owl_Task* previous = atomic_exchange_explicit(&display->task_head, task, memory_order_acq_rel);
+    atomic_store_explicit(&previous->next, task, memory_order_release);
+}
+
+static Owl_Task* pop_task(Owl_Display* display) {
+    Owl_Task* tail = display->task_tail;
+    Owl_Task* next = atomic_load_explicit(&tail->next, memory_order_acquire);
+
+    if (tail == &display->task_stub) {
+        if (!next) {
+            return NULL;
+        }
+        display->task_tail = next;
+        tail = next;
+        next = atomic_load_explicit(&next->next, memory_order_acquire);
+    }
+
+    if (next) {
+        display->task_tail = next;
+        return tail;
+    }
+
+    if (tail != atomic_load_explicit(&display->task_head, memory_order_acquire)) {
+        return NULL;
+    }
+
+    push_task(display, &display->task_stub);
+    next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (next) {
+        display->task_tail = next;
+        return tail;
+    }
+    return NULL;
+}
+
+static void signal_tasks(Owl_Display* display) {
+    if (atomic_exchange(&display->task_signaled, true)) {
+        return;
+    }
+
+    uint64_t value = 1;
+    if (write(display->task_fd, &value, sizeof(value)) < 0) {
+        atomic_store(&display->task_signaled, false);
+    }
+}
+
+static int drain_tasks(Owl_Display* display, int limit) {
+    int ran = 0;
+    while (ran < limit) {
+        Owl_Task* task = pop_task(display);
+        if (!task) {
+            break;
+        }
+        task->callback(display, task->data);
+        free(task);
+        ran++;
+    }
+    return ran;
+}
+
+static int handle_task_event(int fd, uint32_t mask, void* data) {
+    (void)mask;
+    Owl_Display* display = data;
+
+    uint64_t value;
+    if (read(fd, &value, sizeof(value)) < 0) {
+        value = 0;
+    }
+    atomic_store(&display->task_signaled, false);
+
+    if (drain_tasks(display, TASK_BATCH_LIMIT) == TASK_BATCH_LIMIT) {
+        signal_tasks(display);
+    }
+    return 0;
+}
+
+void owl_task_init(Owl_Display* display) {
+    atomic_init(&display->task_stub.next, NULL);
+    atomic_init(&display->task_head, &display->task_stub);
+    atomic_init(&display->task_signaled, false);
+    display->task_tail = &display->task_stub;
+
+    display->task_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (display->task_fd < 0) {
+        fprintf(stderr, "owl: failed to create task eventfd\n");
+        return;
+    }
+
+    display->task_source = wl_event_loop_add_fd(display->event_loop, display->task_fd,
+                                                WL_EVENT_READABLE, handle_task_event, display);
+    if (!display->task_source) {
+        fprintf(stderr, "owl: failed to add task eventfd to event loop\n");
+    }
+}
+
+void owl_task_cleanup(Owl_Display* display) {
+    while (drain_tasks(display, TASK_BATCH_LIMIT) > 0) {
+    }
+
+    if (display->task_source) {
+        wl_event_source_remove(display->task_source);
+        display->task_source = NULL;
+    }
+    if (display->task_fd >= 0) {
+        close(display->task_fd);
+        display->task_fd = -1;
+    }
+}
+
+bool owl_display_post_task(Owl_Display* display, Owl_Task_Callback callback, void* data) {
+    if (!display || !callback || display->task_fd < 0) {
+        return false;
+    }
+
+    Owl_Task* task = malloc(sizeof(Owl_Task));
+    if (!task) {
+        return false;
+    }
+    task->callback = callback;
+    task->data = data;
+
+    push_task(display, task);
+    signal_tasks(display);
+    return true;
+}
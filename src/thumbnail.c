@@ -0,0 +1,192 @@
+#define _GNU_SOURCE
+#include "internal.h"
+#include <stdio.h>
+#include <time.h>
+
+#define THUMBNAIL_MAX_SIZE 256
+#define THUMBNAIL_DEFAULT_INTERVAL_MS 250
+
+static uint32_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+static bool thumbnail_size(Owl_Window* window, int32_t* width, int32_t* height) {
+    Owl_Surface* surface = window->surface;
+    if (!surface || !surface->has_content || surface->texture_width <= 0 || surface->texture_height <= 0) {
+        return false;
+    }
+
+    int32_t source_width = surface->texture_width;
+    int32_t source_height = surface->texture_height;
+    if (source_width <= THUMBNAIL_MAX_SIZE && source_height <= THUMBNAIL_MAX_SIZE) {
+        *width = source_width;
+        *height = source_height;
+    } else if (source_width >= source_height) {
+        *width = THUMBNAIL_MAX_SIZE;
+        *height = (int32_t)((int64_t)source_height * THUMBNAIL_MAX_SIZE / source_width);
+    } else {
+        *width = (int32_t)((int64_t)source_width * THUMBNAIL_MAX_SIZE / source_height);
+        *height = THUMBNAIL_MAX_SIZE;
+    }
+    if (*width < 1) {
+        *width = 1;
+    }
+    if (*height < 1) {
+        *height = 1;
+    }
+    return true;
+}
+
+static uint64_t thumbnail_bytes(Owl_Window* window) {
+    uint64_t bytes = (uint64_t)window->thumbnail_width * window->thumbnail_height * 4;
+    return bytes + bytes / 3;
+}
+
+static bool thumbnail_drawn(Owl_Window* window, bool damage) {
+    Owl_Display* display = window->display;
+    bool drawn = false;
+    for (int index = 0; index < display->output_count; index++) {
+        Owl_Output* output = display->outputs[index];
+        for (int stage = 0; stage < OWL_RENDER_STAGE_COUNT; stage++) {
+            Owl_Draw_Command* command;
+            wl_array_for_each(command, &output->draw_commands[stage]) {
+                if (command->kind != OWL_DRAW_TEXTURE || command->texture_id != window->thumbnail_texture) {
+                    continue;
+                }
+                if (!damage) {
+                    return true;
+                }
+                owl_output_damage(output, command->rect.x, command->rect.y,
+                                  command->rect.width, command->rect.height);
+                drawn = true;
+            }
+        }
+    }
+    return drawn;
+}
+
+static void arm_thumbnail_timer(Owl_Window* window, uint32_t now) {
+    Owl_Display* display = window->display;
+    if (display->thumbnail_armed || !display->thumbnail_timer) {
+        return;
+    }
+
+    uint32_t elapsed = now - window->thumbnail_time;
+    uint32_t delay = elapsed < display->thumbnail_interval_ms ? display->thumbnail_interval_ms - elapsed : 0;
+    wl_event_source_timer_update(display->thumbnail_timer, (int)(delay ? delay : 1));
+    display->thumbnail_armed = true;
+}
+
+static int handle_thumbnail_timer(void* data) {
+    Owl_Display* display = data;
+    display->thumbnail_armed = false;
+
+    Owl_Window* window;
+    wl_list_for_each(window, &display->windows, link) {
+        if (window->thumbnail_dirty && window->thumbnail_texture) {
+            thumbnail_drawn(window, true);
+        }
+    }
+    return 0;
+}
+
+void owl_thumbnail_init(Owl_Display* display) {
+    display->thumbnail_interval_ms = THUMBNAIL_DEFAULT_INTERVAL_MS;
+    display->thumbnail_timer = wl_event_loop_add_timer(display->event_loop, handle_thumbnail_timer, display);
+    if (!display->thumbnail_timer) {
+        fprintf(stderr, "owl: failed to create thumbnail timer\n");
+    }
+}
+
+void owl_thumbnail_cleanup(Owl_Display* display) {
+    if (display->thumbnail_timer) {
+        wl_event_source_remove(display->thumbnail_timer);
+        display->thumbnail_timer = NULL;
+    }
+    display->thumbnail_armed = false;
+}
+
+void owl_thumbnail_mark_dirty(Owl_Window* window) {
+    window->thumbnail_dirty = true;
+    if (window->thumbnail_texture && thumbnail_drawn(window, false)) {
+        arm_thumbnail_timer(window, now_ms());
+    }
+}
+
+bool owl_thumbnail_refresh(Owl_Window* window, bool* regenerated) {
+    Owl_Display* display = window->display;
+    int32_t width, height;
+    if (!thumbnail_size(window, &width, &height)) {
+        return window->thumbnail_texture != 0;
+    }
+
+    uint32_t now = now_ms();
+    bool resized = width != window->thumbnail_width || height != window->thumbnail_height;
+    if (window->thumbnail_texture && !resized &&
+        (!window->thumbnail_dirty || now - window->thumbnail_time < display->thumbnail_interval_ms)) {
+        if (window->thumbnail_dirty && (display->recording_output || thumbnail_drawn(window, false))) {
+            arm_thumbnail_timer(window, now);
+        }
+        return true;
+    }
+
+    display->thumbnail_bytes -= thumbnail_bytes(window);
+    bool updated = owl_render_update_thumbnail(display, window, width, height);
+    display->thumbnail_bytes += thumbnail_bytes(window);
+    if (updated) {
+        window->thumbnail_dirty = false;
+        window->thumbnail_time = now;
+        thumbnail_drawn(window, true);
+        if (regenerated) {
+            *regenerated = true;
+        }
+    }
+    return window->thumbnail_texture != 0;
+}
+
+void owl_thumbnail_window_destroyed(Owl_Window* window) {
+    if (!window->thumbnail_texture) {
+        return;
+    }
+    window->display->thumbnail_bytes -= thumbnail_bytes(window);
+    owl_render_destroy_texture(window->display, window->thumbnail_texture);
+    window->thumbnail_texture = 0;
+}
+
+void owl_display_set_thumbnail_interval(Owl_Display* display, uint32_t interval_ms) {
+    if (display) {
+        display->thumbnail_interval_ms = interval_ms;
+    }
+}
+
+bool owl_window_get_thumbnail_size(Owl_Window* window, int32_t* width, int32_t* height) {
+    int32_t thumbnail_width, thumbnail_height;
+    if (!window || !thumbnail_size(window, &thumbnail_width, &thumbnail_height)) {
+        return false;
+    }
+    if (width) {
+        *width = thumbnail_width;
+    }
+    if (height) {
+        *height = thumbnail_height;
+    }
+    return true;
+}
+
+bool owl_window_read_thumbnail(Owl_Window* window, uint32_t* argb_pixels, int32_t width, int32_t height) {
+    if (!window || !argb_pixels) {
+        return false;
+    }
+
+    Owl_Display* display = window->display;
+    if (!owl_render_make_current(display)) {
+        return false;
+    }
+    if (!owl_thumbnail_refresh(window, NULL) ||
+        width != window->thumbnail_width || height != window->thumbnail_height) {
+        return false;
+    }
+    return owl_render_read_thumbnail(display, window, argb_pixels);
+}
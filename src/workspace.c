@@ -0,0 +1,130 @@
+#define _GNU_SOURCE
+#include "internal.h"
+#include <stdio.h>
+#include <time.h>
+
+#define HIDDEN_FRAME_INTERVAL_MS 1000
+
+static uint32_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+static Owl_Output* window_output(Owl_Window* window) {
+    if (window->output) {
+        return window->output;
+    }
+    Owl_Display* display = window->display;
+    return display->output_count ? display->outputs[0] : NULL;
+}
+
+static bool window_hidden(Owl_Window* window) {
+    Owl_Output* output = window_output(window);
+    return output && window->workspace != output->workspace;
+}
+
+static void arm_hidden_frames(Owl_Display* display) {
+    if (display->hidden_frame_armed || !display->hidden_frame_timer) {
+        return;
+    }
+    wl_event_source_timer_update(display->hidden_frame_timer, HIDDEN_FRAME_INTERVAL_MS);
+    display->hidden_frame_armed = true;
+}
+
+static int handle_hidden_frame_timer(void* data) {
+    Owl_Display* display = data;
+    display->hidden_frame_armed = false;
+    owl_surface_send_hidden_frame_done(display, now_ms());
+    return 0;
+}
+
+void owl_workspace_init(Owl_Display* display) {
+    display->hidden_frame_timer = wl_event_loop_add_timer(display->event_loop,
+                                                          handle_hidden_frame_timer, display);
+    if (!display->hidden_frame_timer) {
+        fprintf(stderr, "owl: failed to create hidden frame timer\n");
+    }
+}
+
+void owl_workspace_cleanup(Owl_Display* display) {
+    if (display->hidden_frame_timer) {
+        wl_event_source_remove(display->hidden_frame_timer);
+        display->hidden_frame_timer = NULL;
+    }
+    display->hidden_frame_armed = false;
+}
+
+void owl_workspace_place_window(Owl_Window* window) {
+    Owl_Output* output = window_output(window);
+    window->workspace = output ? output->workspace : 0;
+    window->hidden = false;
+}
+
+void owl_workspace_update_window(Owl_Window* window) {
+    Owl_Display* display = window->display;
+    bool hidden = window_hidden(window);
+
+    if (window->surface) {
+        window->surface->hidden = hidden;
+        owl_workspace_surface_committed(window->surface);
+    }
+    if (hidden == window->hidden) {
+        return;
+    }
+
+    window->hidden = hidden;
+    owl_spatial_update_window(display, window);
+    owl_stack_sync(window);
+    if (window->mapped) {
+        owl_display_schedule_frame(display);
+    }
+}
+
+void owl_workspace_surface_committed(Owl_Surface* surface) {
+    if (surface->hidden && !wl_list_empty(&surface->current.frame_callbacks)) {
+        arm_hidden_frames(surface->display);
+    }
+}
+
+void owl_output_set_workspace(Owl_Output* output, uint32_t workspace) {
+    if (!output || output->workspace == workspace) {
+        return;
+    }
+
+    output->workspace = workspace;
+
+    Owl_Window* window;
+    wl_list_for_each(window, &output->display->windows, link) {
+        if (window_output(window) == output) {
+            owl_workspace_update_window(window);
+        }
+    }
+}
+
+uint32_t owl_output_get_workspace(Owl_Output* output) {
+    return output ? output->workspace : 0;
+}
+
+void owl_window_set_workspace(Owl_Window* window, Owl_Output* output, uint32_t workspace) {
+    if (!window) {
+        return;
+    }
+    if (output) {
+        window->output = output;
+    }
+    window->workspace = workspace;
+    owl_workspace_update_window(window);
+}
+
+uint32_t owl_window_get_workspace(Owl_Window* window) {
+    return window ? window->workspace : 0;
+}
+
+Owl_Output* owl_window_get_output(Owl_Window* window) {
+    return window ? window_output(window) : NULL;
+}
+
+bool owl_window_is_hidden(Owl_Window* window) {
+    return window && window->hidden;
+}
@@ -69,21 +69,38 @@ static void xdg_toplevel_show_window_menu(struct wl_client* client, struct wl_re
     (void)y;
 }
 
+static bool accept_grab_request(Owl_Window* window, struct wl_client* client, uint32_t serial,
+                                Owl_Window_Event event) {
+    Owl_Display* display = window->display;
+    Owl_Client* focus = display->pointer_focus_client;
+    if (display->buttons_pressed == 0 || !focus || focus->client != client ||
+        serial != display->button_serial) {
+        return false;
+    }
+
+    display->grab_request_denied = false;
+    owl_invoke_window_callback(display, event, window);
+    return !display->grab_request_denied;
+}
+
 static void xdg_toplevel_move(struct wl_client* client, struct wl_resource* resource,
                               struct wl_resource* seat, uint32_t serial) {
-    (void)client;
-    (void)resource;
     (void)seat;
-    (void)serial;
+
+    Owl_Window* window = wl_resource_get_user_data(resource);
+    if (window && accept_grab_request(window, client, serial, OWL_WINDOW_EVENT_REQUEST_MOVE)) {
+        owl_window_begin_move(window);
+    }
 }
 
 static void xdg_toplevel_resize(struct wl_client* client, struct wl_resource* resource,
                                 struct wl_resource* seat, uint32_t serial, uint32_t edges) {
-    (void)client;
-    (void)resource;
     (void)seat;
-    (void)serial;
-    (void)edges;
+
+    Owl_Window* window = wl_resource_get_user_data(resource);
+    if (window && accept_grab_request(window, client, serial, OWL_WINDOW_EVENT_REQUEST_RESIZE)) {
+        owl_window_begin_resize(window, edges);
+    }
 }
 
 static void xdg_toplevel_set_max_size(struct wl_client* client, struct wl_resource* resource,
@@ -123,6 +140,7 @@ static void xdg_toplevel_set_fullscreen(struct wl_client* client, struct wl_reso
     }
 
     window->fullscreen = true;
+    owl_xdg_toplevel_schedule_configure(window, window->width, window->height);
     owl_invoke_window_callback(window->display, OWL_WINDOW_EVENT_FULLSCREEN, window);
 }
 
@@ -135,6 +153,7 @@ static void xdg_toplevel_unset_fullscreen(struct wl_client* client, struct wl_re
     }
 
     window->fullscreen = false;
+    owl_xdg_toplevel_schedule_configure(window, window->width, window->height);
     owl_invoke_window_callback(window->display, OWL_WINDOW_EVENT_FULLSCREEN, window);
 }
 
@@ -167,20 +186,36 @@ static void xdg_toplevel_destroy_handler(struct wl_resource* resource) {
     }
 
     window->xdg_toplevel_resource = NULL;
+    wl_list_remove(&window->configure_link);
+    wl_list_init(&window->configure_link);
+    window->configure_scheduled = false;
 }
 
-static void send_toplevel_configure(Owl_Window* window) {
-    struct wl_array states;
-    wl_array_init(&states);
-
+static uint32_t toplevel_states(Owl_Window* window) {
+    uint32_t states = 0;
     if (window->focused) {
-        uint32_t* state = wl_array_add(&states, sizeof(uint32_t));
-        *state = XDG_TOPLEVEL_STATE_ACTIVATED;
+        states |= 1u << XDG_TOPLEVEL_STATE_ACTIVATED;
     }
-
     if (window->fullscreen) {
-        uint32_t* state = wl_array_add(&states, sizeof(uint32_t));
-        *state = XDG_TOPLEVEL_STATE_FULLSCREEN;
+        states |= 1u << XDG_TOPLEVEL_STATE_FULLSCREEN;
+    }
+    if (window->resizing) {
+        states |= 1u << XDG_TOPLEVEL_STATE_RESIZING;
+    }
+    return states;
+}
+
+static void send_toplevel_configure(Owl_Window* window, uint32_t state_bits) {
+    struct wl_array states;
+    wl_array_init(&states);
+
+    for (uint32_t state = 0; state < 32; state++) {
+        if (state_bits & (1u << state)) {
+            uint32_t* entry = wl_array_add(&states, sizeof(uint32_t));
+            if (entry) {
+                *entry = state;
+            }
+        }
     }
 
     xdg_toplevel_send_configure(window->xdg_toplevel_resource,
@@ -189,6 +224,34 @@ static void send_toplevel_configure(Owl_Window* window) {
     wl_array_release(&states);
 }
 
+static void flush_configure(Owl_Window* window) {
+    wl_list_remove(&window->configure_link);
+    wl_list_init(&window->configure_link);
+    window->configure_scheduled = false;
+
+    if (!window->xdg_toplevel_resource || !window->xdg_surface_resource) {
+        return;
+    }
+
+    uint32_t states = toplevel_states(window);
+    if (window->configure_sent && window->sent_width == window->width &&
+        window->sent_height == window->height && window->sent_states == states) {
+        return;
+    }
+
+    send_toplevel_configure(window, states);
+
+    uint32_t serial = wl_display_next_serial(window->display->wayland_display);
+    window->pending_serial = serial;
+    window->pending_configure = true;
+    window->configure_sent = true;
+    window->sent_width = window->width;
+    window->sent_height = window->height;
+    window->sent_states = states;
+    xdg_surface_send_configure(window->xdg_surface_resource, serial);
+    owl_debug("configure window=%p %dx%d serial=%u\n", (void*)window, window->width, window->height, serial);
+}
+
 static void xdg_surface_destroy(struct wl_client* client, struct wl_resource* resource) {
     (void)client;
     wl_resource_destroy(resource);
@@ -215,13 +278,9 @@ static void xdg_surface_get_toplevel(struct wl_client* client, struct wl_resourc
     wl_resource_set_implementation(window->xdg_toplevel_resource, &toplevel_interface,
                                    window, xdg_toplevel_destroy_handler);
 
-    owl_debug("  sending initial configure\n");
-    send_toplevel_configure(window);
-    static uint32_t configure_serial = 1;
-    window->pending_serial = configure_serial;
-    window->pending_configure = true;
-    xdg_surface_send_configure(window->xdg_surface_resource, configure_serial++);
-    owl_debug("  configure sent\n");
+    owl_debug("  scheduling initial configure\n");
+    window->configure_sent = false;
+    owl_xdg_toplevel_schedule_configure(window, window->width, window->height);
 
     fprintf(stderr, "owl: xdg_toplevel created\n");
 }
@@ -267,8 +326,10 @@ static void xdg_surface_get_popup(struct wl_client* client, struct wl_resource*
     }
     wl_resource_set_implementation(popup, &popup_interface, NULL, NULL);
 
+    Owl_Window* window = wl_resource_get_user_data(resource);
+    uint32_t serial = window ? wl_display_next_serial(window->display->wayland_display) : 1;
     xdg_popup_send_configure(popup, 0, 0, 100, 100);
-    xdg_surface_send_configure(resource, 1);
+    xdg_surface_send_configure(resource, serial);
 }
 
 static void xdg_surface_set_window_geometry(struct wl_client* client, struct wl_resource* resource,
@@ -285,6 +346,8 @@ static void xdg_surface_set_window_geometry(struct wl_client* client, struct wl_
     if (window->width != width || window->height != height) {
         window->width = width;
         window->height = height;
+        owl_spatial_update_window(window->display, window);
+        owl_stack_sync(window);
     }
 }
 
@@ -297,9 +360,11 @@ static void xdg_surface_ack_configure(struct wl_client* client, struct wl_resour
         return;
     }
 
-    if (window->pending_serial == serial) {
+    if ((int32_t)(serial - window->pending_serial) >= 0) {
         window->pending_configure = false;
     }
+    owl_layout_configure_acked(window, serial);
+    owl_grab_configure_acked(window);
 }
 
 static const struct xdg_surface_interface surface_interface = {
@@ -318,11 +383,21 @@ static void xdg_surface_destroy_handler(struct wl_resource* resource) {
 
     if (window->mapped) {
         window->mapped = false;
+        owl_windows_changed(window->display);
         owl_invoke_window_callback(window->display, OWL_WINDOW_EVENT_DESTROY, window);
     }
 
+    owl_grab_window_destroyed(window);
+    owl_layout_window_destroyed(window);
+    owl_thumbnail_window_destroyed(window);
+    owl_drop_window_events(window->display, window);
+    wl_list_remove(&window->configure_link);
+    owl_spatial_remove_window(window->display, window);
+    owl_stack_remove(window->display, window);
     wl_list_remove(&window->link);
     window->display->window_count--;
+    owl_windows_changed(window->display);
+    owl_display_schedule_frame(window->display);
 
     free(window->title);
     free(window->app_id);
@@ -456,6 +531,9 @@ static void xdg_wm_base_get_xdg_surface(struct wl_client* client, struct wl_reso
     window->surface = surface;
     window->width = 0;
     window->height = 0;
+    window->stack_index = -1;
+    wl_list_init(&window->configure_link);
+    owl_workspace_place_window(window);
 
     uint32_t version = wl_resource_get_version(resource);
     owl_debug("  creating xdg_surface resource version %d\n", version);
@@ -470,6 +548,15 @@ static void xdg_wm_base_get_xdg_surface(struct wl_client* client, struct wl_reso
     wl_resource_set_implementation(window->xdg_surface_resource, &surface_interface,
                                    window, xdg_surface_destroy_handler);
 
+    if (!owl_stack_insert(display, window)) {
+        owl_debug("  failed to grow window stack\n");
+        wl_resource_set_user_data(window->xdg_surface_resource, NULL);
+        wl_resource_destroy(window->xdg_surface_resource);
+        free(window);
+        wl_resource_post_no_memory(resource);
+        return;
+    }
+
     wl_list_insert(&display->windows, &window->link);
     display->window_count++;
 
@@ -479,9 +566,11 @@ static void xdg_wm_base_get_xdg_surface(struct wl_client* client, struct wl_reso
 
 static void xdg_wm_base_pong(struct wl_client* client, struct wl_resource* resource,
                              uint32_t serial) {
-    (void)client;
     (void)resource;
-    (void)serial;
+    Owl_Client* owner = owl_client_from_wl(client);
+    if (owner) {
+        owl_ping_handle_pong(owner, serial);
+    }
 }
 
 static const struct xdg_wm_base_interface wm_base_interface = {
@@ -491,6 +580,14 @@ static const struct xdg_wm_base_interface wm_base_interface = {
     .pong = xdg_wm_base_pong,
 };
 
+static void wm_base_destroy_handler(struct wl_resource* resource) {
+    Owl_Client* owner = owl_client_from_resource(resource);
+    if (owner && owner->wm_base == resource) {
+        owner->wm_base = NULL;
+        owner->ping_pending = false;
+    }
+}
+
 static void wm_base_bind(struct wl_client* client, void* data, uint32_t version, uint32_t id) {
     Owl_Display* display = data;
 
@@ -501,12 +598,20 @@ static void wm_base_bind(struct wl_client* client, void* data, uint32_t version,
         return;
     }
 
-    wl_resource_set_implementation(resource, &wm_base_interface, display, NULL);
+    wl_resource_set_implementation(resource, &wm_base_interface, display, wm_base_destroy_handler);
+
+    Owl_Client* owner = owl_client_from_wl(client);
+    if (owner) {
+        owner->wm_base = resource;
+        owner->ping_pending = false;
+    }
 }
 
 static struct wl_global* xdg_wm_base_global = NULL;
 
 void owl_xdg_shell_init(Owl_Display* display) {
+    wl_list_init(&display->configure_queue);
+
     xdg_wm_base_global = wl_global_create(display->wayland_display,
         &xdg_wm_base_interface, 3, display, wm_base_bind);
 
@@ -527,21 +632,27 @@ void owl_xdg_shell_cleanup(Owl_Display* display) {
     }
 }
 
-void owl_xdg_toplevel_send_configure(Owl_Window* window, int width, int height) {
+void owl_xdg_toplevel_schedule_configure(Owl_Window* window, int width, int height) {
     if (!window || !window->xdg_toplevel_resource || !window->xdg_surface_resource) {
         return;
     }
 
     window->width = width;
     window->height = height;
+    owl_spatial_update_window(window->display, window);
+    owl_stack_sync(window);
 
-    send_toplevel_configure(window);
-
-    static uint32_t serial = 1;
-    window->pending_serial = serial;
-    window->pending_configure = true;
+    if (!window->configure_scheduled) {
+        window->configure_scheduled = true;
+        wl_list_insert(window->display->configure_queue.prev, &window->configure_link);
+    }
+}
 
-    xdg_surface_send_configure(window->xdg_surface_resource, serial++);
+void owl_xdg_flush_configures(Owl_Display* display) {
+    while (!wl_list_empty(&display->configure_queue)) {
+        Owl_Window* window = wl_container_of(display->configure_queue.next, window, configure_link);
+        flush_configure(window);
+    }
 }
 
 void owl_xdg_toplevel_send_close(Owl_Window* window) {
@@ -558,9 +669,10 @@ void owl_window_map(Owl_Window* window) {
     }
 
     window->mapped = true;
+    owl_windows_changed(window->display);
+    owl_spatial_update_window(window->display, window);
+    owl_stack_sync(window);
     owl_invoke_window_callback(window->display, OWL_WINDOW_EVENT_CREATE, window);
 
-    for (int index = 0; index < window->display->output_count; index++) {
-        owl_render_frame(window->display, window->display->outputs[index]);
-    }
+    owl_display_schedule_frame(window->display);
 }